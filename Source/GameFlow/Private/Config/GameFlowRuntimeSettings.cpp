@@ -0,0 +1,16 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Config/GameFlowRuntimeSettings.h"
+
+UGameFlowRuntimeSettings::UGameFlowRuntimeSettings()
+{
+	FrameBudgetMs = 0.f;
+	TimerResolutionMs = 10.f;
+	bCoalesceListenerEvents = false;
+	EventBusCapacity = 256;
+	bEnableSpatialListenerQueries = false;
+	ListenerGridCellSize = 2000.f;
+	SubgraphPreloadHops = -1;
+	bInlineSubgraphsOnCook = false;
+	AssetPrefetchHops = 0;
+}
@@ -0,0 +1,183 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowAutosave.h"
+#include "GameFlowMemory.h"
+#include "Async/Async.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tasks/Task.h"
+
+namespace
+{
+	constexpr uint32 AutosaveMagic = 0x53414647; // "GFAS"
+	constexpr uint16 AutosaveVersion = 2;
+
+	/** First version whose header tells whether the payload is compressed. Older payloads always are. */
+	constexpr uint16 AutosaveVersion_CompressionFlag = 2;
+
+	void SerializeSavedInstance(FArchive& Ar, uint64& Key, FGameFlowSavedInstance& Instance)
+	{
+		FString AssetPath = Instance.Asset.ToString();
+		Ar << Key << AssetPath << Instance.Snapshot;
+		if (Ar.IsLoading())
+		{
+			Instance.Asset.SetPath(AssetPath);
+		}
+	}
+}
+
+bool FGameFlowAutosave::Decode(const TArray<uint8>& Data, FGameFlowSavedInstances& InOutInstances, uint32& InOutSequence)
+{
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	uint32 Sequence = 0;
+	uint32 BaseSequence = 0;
+	int32 UncompressedSize = 0;
+	Reader << Magic << Version << Sequence << BaseSequence << UncompressedSize;
+	bool bIsCompressed = true;
+	if (Version >= AutosaveVersion_CompressionFlag)
+	{
+		Reader << bIsCompressed;
+	}
+	if (Reader.IsError() || Magic != AutosaveMagic || Version == 0 || Version > AutosaveVersion || UncompressedSize < 0) return false;
+	if (BaseSequence != 0 && BaseSequence != InOutSequence) return false;
+
+	const int64 PayloadOffset = Reader.Tell();
+	const int32 StoredSize = static_cast<int32>(Data.Num() - PayloadOffset);
+	TArray<uint8> Payload;
+	if (bIsCompressed)
+	{
+		Payload.SetNumUninitialized(UncompressedSize);
+		if (!FCompression::UncompressMemory(NAME_Oodle, Payload.GetData(), UncompressedSize, Data.GetData() + PayloadOffset, StoredSize))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (StoredSize != UncompressedSize) return false;
+		Payload.Append(Data.GetData() + PayloadOffset, StoredSize);
+	}
+
+	FGameFlowSavedInstances Instances = BaseSequence != 0? InOutInstances : FGameFlowSavedInstances();
+	FMemoryReader PayloadReader(Payload);
+	int32 NumChanged = 0;
+	PayloadReader << NumChanged;
+	for (int32 Index = 0; Index < NumChanged && !PayloadReader.IsError(); ++Index)
+	{
+		uint64 Key = 0;
+		FGameFlowSavedInstance Instance;
+		SerializeSavedInstance(PayloadReader, Key, Instance);
+		Instances.Add(Key, MoveTemp(Instance));
+	}
+	
+	int32 NumRemoved = 0;
+	PayloadReader << NumRemoved;
+	for (int32 Index = 0; Index < NumRemoved && !PayloadReader.IsError(); ++Index)
+	{
+		uint64 Key = 0;
+		PayloadReader << Key;
+		Instances.Remove(Key);
+	}
+	if (PayloadReader.IsError()) return false;
+
+	InOutInstances = MoveTemp(Instances);
+	InOutSequence = Sequence;
+	return true;
+}
+
+FGameFlowAutosaver::FGameFlowAutosaver()
+	: State(MakeShared<FState, ESPMode::ThreadSafe>())
+{
+}
+
+void FGameFlowAutosaver::Encode(TArray<TPair<uint64, FGameFlowSavedInstance>>&& ChangedInstances, TSet<uint64>&& RunningInstances,
+	bool bFull, FOnGameFlowAutosaved OnComplete)
+{
+	check(IsInGameThread() && !IsEncoding());
+	check(bFull || bHasPreviousAutosave);
+	State->bIsEncoding = true;
+	bHasPreviousAutosave = true;
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [State = State, Changed = MoveTemp(ChangedInstances),
+		Running = MoveTemp(RunningInstances), bFull, OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		LLM_SCOPE_BYTAG(GameFlow_Instances);
+		FGameFlowAutosave Autosave;
+		Autosave.Sequence = State->Sequence + 1;
+		Autosave.BaseSequence = bFull? 0 : State->Sequence;
+		Autosave.NumChangedInstances = Changed.Num();
+		if (bFull)
+		{
+			State->Instances.Reset();
+		}
+
+		// Changed instances first, then the instances which stopped running.
+		TArray<uint8> Payload;
+		FMemoryWriter Writer(Payload);
+		int32 NumChanged = Changed.Num();
+		Writer << NumChanged;
+		for (TPair<uint64, FGameFlowSavedInstance>& Instance : Changed)
+		{
+			SerializeSavedInstance(Writer, Instance.Key, Instance.Value);
+		}
+
+		TArray<uint64> Removed;
+		for (const TPair<uint64, FGameFlowSavedInstance>& Instance : State->Instances)
+		{
+			if (!Running.Contains(Instance.Key))
+			{
+				Removed.Add(Instance.Key);
+			}
+		}
+		int32 NumRemoved = Removed.Num();
+		Writer << NumRemoved;
+		for (uint64 Key : Removed)
+		{
+			Writer << Key;
+			State->Instances.Remove(Key);
+		}
+
+		for (TPair<uint64, FGameFlowSavedInstance>& Instance : Changed)
+		{
+			State->Instances.Add(Instance.Key, MoveTemp(Instance.Value));
+		}
+		State->Sequence = Autosave.Sequence;
+
+		int32 UncompressedSize = Payload.Num();
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, UncompressedSize);
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(CompressedSize);
+		// The saved state has already been updated, store the payload as is rather than failing the autosave.
+		bool bIsCompressed = FCompression::CompressMemory(NAME_Oodle, Compressed.GetData(), CompressedSize, Payload.GetData(), UncompressedSize)
+			&& CompressedSize < UncompressedSize;
+		const TArray<uint8>& StoredPayload = bIsCompressed? Compressed : Payload;
+		const int32 StoredSize = bIsCompressed? CompressedSize : UncompressedSize;
+		
+		FMemoryWriter HeaderWriter(Autosave.Data);
+		uint32 Magic = AutosaveMagic;
+		uint16 Version = AutosaveVersion;
+		HeaderWriter << Magic << Version << Autosave.Sequence << Autosave.BaseSequence << UncompressedSize << bIsCompressed;
+		Autosave.Data.Append(StoredPayload.GetData(), StoredSize);
+
+		AsyncTask(ENamedThreads::GameThread, [State = MoveTemp(State), Autosave = MoveTemp(Autosave), OnComplete = MoveTemp(OnComplete)]()
+		{
+			State->bIsEncoding = false;
+			OnComplete.ExecuteIfBound(Autosave);
+		});
+	});
+}
+
+bool FGameFlowAutosaver::IsEncoding() const
+{
+	return State->bIsEncoding;
+}
+
+void FGameFlowAutosaver::Reset()
+{
+	// A running task keeps updating the previous state, start from a new one.
+	State = MakeShared<FState, ESPMode::ThreadSafe>();
+	bHasPreviousAutosave = false;
+}
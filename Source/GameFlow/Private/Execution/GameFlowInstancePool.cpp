@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowInstancePool.h"
+#include "GameFlowAsset.h"
+#include "GameFlowStats.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+UGameFlowAsset* FGameFlowInstancePool::Acquire(UObject* Outer)
+{
+	if (FreeInstances.Num() > 0)
+	{
+#if (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4) || ENGINE_MAJOR_VERSION >= 6
+		return FreeInstances.Pop(EAllowShrinking::No);
+#else
+		return FreeInstances.Pop(false);
+#endif
+	}
+	return CreateInstance(Outer);
+}
+
+bool FGameFlowInstancePool::Release(UGameFlowAsset* Instance)
+{
+	if (Instance == nullptr) return false;
+	
+	// Duplicated graphs may have mutated node objects, which cannot be reset.
+	if (!Instance->IsSharedInstance() || FreeInstances.Num() >= Asset->MaxPooledInstances)
+	{
+		INC_DWORD_STAT(STAT_GameFlow_InstancesDestroyed);
+		return false;
+	}
+
+	Instance->ResetInstance();
+	FreeInstances.Add(Instance);
+	return true;
+}
+
+void FGameFlowInstancePool::Prewarm(UObject* Outer, int32 Count)
+{
+	if (Asset == nullptr) return;
+
+	FreeInstances.Reserve(Count);
+	while (FreeInstances.Num() < Count)
+	{
+		UGameFlowAsset* Instance = CreateInstance(Outer);
+		if (Instance == nullptr) break;
+		
+		FreeInstances.Add(Instance);
+	}
+}
+
+UGameFlowAsset* FGameFlowInstancePool::CreateInstance(UObject* Outer) const
+{
+	UGameFlowAsset* Instance = Asset != nullptr? Asset->CreateInstance(Outer) : nullptr;
+	if (Instance != nullptr)
+	{
+		INC_DWORD_STAT(STAT_GameFlow_InstancesCreated);
+	}
+	return Instance;
+}
@@ -0,0 +1,104 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowInstanceState.h"
+#include "Execution/GameFlowProgram.h"
+#include "Nodes/GameFlowNode.h"
+
+UGameFlowAsset* FGameFlowInstanceScope::CurrentInstance = nullptr;
+
+void FGameFlowInstanceState::Initialize(const FGameFlowProgram& InProgram)
+{
+	Release();
+
+	Program = &InProgram;
+	Size = InProgram.GetStateSize();
+	LayoutHash = InProgram.GetLayoutHash();
+	if (Size > 0)
+	{
+		Memory = static_cast<uint8*>(FMemory::Malloc(Size, InProgram.GetStateAlignment()));
+	}
+
+	Slots.SetNum(InProgram.Nodes.Num());
+	for (int32 NodeIndex = 0; NodeIndex < InProgram.Nodes.Num(); ++NodeIndex)
+	{
+		const FGameFlowProgramNode& ProgramNode = InProgram.Nodes[NodeIndex];
+		if (ProgramNode.StateOffset == INDEX_NONE) continue;
+
+		FNodeStateSlot& Slot = Slots[NodeIndex];
+		Slot.Offset = ProgramNode.StateOffset;
+		Slot.Struct = ProgramNode.Node->GetInstanceStateStruct();
+		void* NodeState = Memory + Slot.Offset;
+		Slot.Struct->InitializeStruct(NodeState);
+		ProgramNode.Node->InitializeInstanceState(NodeState, ProgramNode);
+	}
+}
+
+void FGameFlowInstanceState::Reset()
+{
+	if (Program == nullptr) return;
+
+	// The offsets of the block no longer match the program nodes, lay it out again.
+	if (IsStale())
+	{
+		Initialize(*Program);
+		return;
+	}
+
+	for (int32 NodeIndex = 0; NodeIndex < Slots.Num(); ++NodeIndex)
+	{
+		const FNodeStateSlot& Slot = Slots[NodeIndex];
+		if (Slot.Offset == INDEX_NONE) continue;
+
+		void* NodeState = Memory + Slot.Offset;
+		Slot.Struct->DestroyStruct(NodeState);
+		Slot.Struct->InitializeStruct(NodeState);
+		Program->Nodes[NodeIndex].Node->InitializeInstanceState(NodeState, Program->Nodes[NodeIndex]);
+	}
+}
+
+void FGameFlowInstanceState::Release()
+{
+	// Destroy the structs the block has been laid out with, the program may have changed since.
+	if (Memory != nullptr)
+	{
+		for (const FNodeStateSlot& Slot : Slots)
+		{
+			if (Slot.Offset == INDEX_NONE) continue;
+
+			Slot.Struct->DestroyStruct(Memory + Slot.Offset);
+		}
+	}
+
+	FMemory::Free(Memory);
+	Memory = nullptr;
+	Program = nullptr;
+	Size = 0;
+	LayoutHash = 0;
+	Slots.Reset();
+}
+
+bool FGameFlowInstanceState::IsStale() const
+{
+	return Program != nullptr && (Program->GetLayoutHash() != LayoutHash || Program->GetStateSize() != Size
+		|| Program->Nodes.Num() != Slots.Num());
+}
+
+void* FGameFlowInstanceState::GetNodeState(int32 NodeIndex) const
+{
+	if (!Slots.IsValidIndex(NodeIndex) || IsStale()) return nullptr;
+
+	const int32 StateOffset = Slots[NodeIndex].Offset;
+	return StateOffset != INDEX_NONE? Memory + StateOffset : nullptr;
+}
+
+FGameFlowInstanceScope::FGameFlowInstanceScope(UGameFlowAsset* Instance)
+	: PreviousInstance(CurrentInstance)
+{
+	check(IsInGameThread());
+	CurrentInstance = Instance;
+}
+
+FGameFlowInstanceScope::~FGameFlowInstanceScope()
+{
+	CurrentInstance = PreviousInstance;
+}
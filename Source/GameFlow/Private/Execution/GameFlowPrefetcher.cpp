@@ -0,0 +1,81 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowPrefetcher.h"
+#include "Engine/AssetManager.h"
+#include "Execution/GameFlowProgram.h"
+
+void FGameFlowPrefetcher::Activate(const FGameFlowProgram& Program, int32 NodeIndex)
+{
+	if (IsActive(NodeIndex) || !Program.Nodes.IsValidIndex(NodeIndex)) return;
+
+	if (ActiveNodes.Num() < Program.Nodes.Num())
+	{
+		ActiveNodes.Add(false, Program.Nodes.Num() - ActiveNodes.Num());
+	}
+	ActiveNodes[NodeIndex] = true;
+
+	const FGameFlowProgramNode& ProgramNode = Program.Nodes[NodeIndex];
+	for (int32 Index = ProgramNode.FirstPrefetch; Index < ProgramNode.FirstPrefetch + ProgramNode.NumPrefetch; ++Index)
+	{
+		const int32 TargetIndex = Program.PrefetchTargets[Index];
+		FRequest& Request = Requests.FindOrAdd(TargetIndex);
+		if (Request.RefCount++ > 0) continue;
+
+		const FGameFlowProgramNode& TargetNode = Program.Nodes[TargetIndex];
+		FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+		// Most targets reference a single asset, request it directly instead of building a paths array.
+		if (TargetNode.NumPrefetchPaths == 1)
+		{
+			Request.Handle = StreamableManager.RequestAsyncLoad(Program.PrefetchPaths[TargetNode.FirstPrefetchPath],
+				FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+		}
+		else
+		{
+			TArray<FSoftObjectPath> Paths(&Program.PrefetchPaths[TargetNode.FirstPrefetchPath], TargetNode.NumPrefetchPaths);
+			Request.Handle = StreamableManager.RequestAsyncLoad(MoveTemp(Paths),
+				FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+		}
+	}
+}
+
+void FGameFlowPrefetcher::Deactivate(const FGameFlowProgram& Program, int32 NodeIndex)
+{
+	if (!IsActive(NodeIndex)) return;
+
+	ActiveNodes[NodeIndex] = false;
+	const FGameFlowProgramNode& ProgramNode = Program.Nodes[NodeIndex];
+	for (int32 Index = ProgramNode.FirstPrefetch; Index < ProgramNode.FirstPrefetch + ProgramNode.NumPrefetch; ++Index)
+	{
+		const int32 TargetIndex = Program.PrefetchTargets[Index];
+		FRequest* Request = Requests.Find(TargetIndex);
+		if (Request == nullptr || --Request->RefCount > 0) continue;
+
+		// Cancels the load if still pending, or lets the loaded assets be collected.
+		if (Request->Handle.IsValid())
+		{
+			Request->Handle->CancelHandle();
+		}
+		Requests.Remove(TargetIndex);
+	}
+}
+
+void FGameFlowPrefetcher::GetActiveNodes(TArray<int32>& OutNodes) const
+{
+	for (TConstSetBitIterator<> It(ActiveNodes); It; ++It)
+	{
+		OutNodes.Add(It.GetIndex());
+	}
+}
+
+void FGameFlowPrefetcher::Reset()
+{
+	for (const auto& [TargetIndex, Request] : Requests)
+	{
+		if (Request.Handle.IsValid())
+		{
+			Request.Handle->CancelHandle();
+		}
+	}
+	Requests.Reset();
+	ActiveNodes.Reset();
+}
@@ -0,0 +1,621 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowProgram.h"
+#include "GameFlowAsset.h"
+#include "Config/GameFlowRuntimeSettings.h"
+#include "Nodes/GameFlowNode.h"
+#include "Algo/StableSort.h"
+#include "GameFramework/GameSession.h"
+
+#if WITH_EDITOR
+#include "Nodes/Flow/GameFlowNode_FlowControl_Subgraph.h"
+#endif
+
+namespace
+{
+	/**
+	 * Append the pins of a node to a program pins table. Pins declared at compile time by the
+	 * node class come first and in declaration order, so that their position relative to the
+	 * first node pin matches their declared index. Remaining (user-defined) pins follow.
+	 */
+	template<typename TPinHandle>
+	void LayOutPins(int32 NodeIndex, TConstArrayView<FName> DeclaredPins, const TMap<FName, TPinHandle*>& NodePins,
+		TArray<FGameFlowProgramPin>& PinsTable, TMap<const UPinHandle*, int32>* OutPinIndices)
+	{
+		auto AddPin = [&](FName PinName, TPinHandle* PinHandle)
+		{
+			if (OutPinIndices != nullptr && PinHandle != nullptr)
+			{
+				OutPinIndices->Add(PinHandle, PinsTable.Num());
+			}
+			
+			FGameFlowProgramPin& ProgramPin = PinsTable.AddDefaulted_GetRef();
+			ProgramPin.PinName = PinName;
+			ProgramPin.NodeIndex = NodeIndex;
+#if WITH_EDITORONLY_DATA
+			ProgramPin.Handle = PinHandle;
+#endif
+		};
+
+		// Declared pins are always compiled, even when missing from the node, to keep indices dense.
+		for (const FName& PinName : DeclaredPins)
+		{
+			AddPin(PinName, NodePins.FindRef(PinName));
+		}
+
+		for (const auto& [PinName, PinHandle] : NodePins)
+		{
+			if (!DeclaredPins.Contains(PinName))
+			{
+				AddPin(PinName, PinHandle);
+			}
+		}
+	}
+}
+
+void FGameFlowProgram::Compile(const UGameFlowAsset* Asset)
+{
+#if WITH_EDITORONLY_DATA
+	Reset();
+	if (Asset == nullptr) return;
+
+	// Collect all the nodes of the asset: entry points, all the graph nodes and the nodes reachable
+	// from them by walking output pins connections. The collection order does not matter, nodes
+	// are sorted by GUID below to get stable indices.
+	TArray<UGameFlowNode*> CompiledNodes;
+	for (const auto& [EntryPointName, InputNode] : Asset->CustomInputs)
+	{
+		if (InputNode != nullptr)
+		{
+			CompiledNodes.AddUnique(InputNode);
+		}
+	}
+
+	// Also compile nodes which are not reachable from any entry point.
+	for (const auto& [GUID, Node] : Asset->Nodes)
+	{
+		if (Node != nullptr)
+		{
+			CompiledNodes.AddUnique(Node);
+		}
+	}
+
+	for (int32 Index = 0; Index < CompiledNodes.Num(); ++Index)
+	{
+		for (const auto& [PinName, OutputPin] : CompiledNodes[Index]->Outputs)
+		{
+			if (OutputPin == nullptr) continue;
+
+			for (const UPinHandle* ConnectedPin : OutputPin->GetConnections())
+			{
+				UGameFlowNode* ConnectedNode = ConnectedPin != nullptr? ConnectedPin->GetNodeOwner() : nullptr;
+				if (ConnectedNode != nullptr)
+				{
+					CompiledNodes.AddUnique(ConnectedNode);
+				}
+			}
+		}
+	}
+
+	// Node indices are the node IDs used by cooked builds. Order nodes by GUID, so that they
+	// do not depend on the discovery order and stay the same as long as the graph is unchanged.
+	Algo::StableSort(CompiledNodes, [](const UGameFlowNode* A, const UGameFlowNode* B)
+	{
+		return A->GUID < B->GUID;
+	});
+
+	// Lay out nodes and their pins inside contiguous tables.
+	TMap<const UPinHandle*, int32> InputPinIndices;
+	Nodes.Reserve(CompiledNodes.Num());
+	for (int32 NodeIndex = 0; NodeIndex < CompiledNodes.Num(); ++NodeIndex)
+	{
+		UGameFlowNode* Node = CompiledNodes[NodeIndex];
+		Node->ProgramIndex = NodeIndex;
+
+		FGameFlowProgramNode& ProgramNode = Nodes.AddDefaulted_GetRef();
+		ProgramNode.Node = Node;
+
+		ProgramNode.FirstInput = InputPins.Num();
+		LayOutPins(NodeIndex, Node->GetDeclaredInputPins(), Node->Inputs, InputPins, &InputPinIndices);
+		ProgramNode.NumInputs = InputPins.Num() - ProgramNode.FirstInput;
+
+		ProgramNode.FirstOutput = OutputPins.Num();
+		LayOutPins(NodeIndex, Node->GetDeclaredOutputPins(), Node->Outputs, OutputPins, nullptr);
+		ProgramNode.NumOutputs = OutputPins.Num() - ProgramNode.FirstOutput;
+	}
+
+	// Lower output pins connections into CSR edges.
+	for (FGameFlowProgramPin& ProgramPin : OutputPins)
+	{
+		const UGameFlowNode* Node = Nodes[ProgramPin.NodeIndex].Node;
+		const UOutPinHandle* OutputPin = Node->Outputs.FindRef(ProgramPin.PinName);
+
+		ProgramPin.FirstEdge = Edges.Num();
+		if (OutputPin != nullptr)
+		{
+			for (const UPinHandle* ConnectedPin : OutputPin->GetConnections())
+			{
+				const int32* InputPinIndex = InputPinIndices.Find(ConnectedPin);
+				if (InputPinIndex != nullptr)
+				{
+					Edges.Add(*InputPinIndex);
+				}
+			}
+		}
+		ProgramPin.NumEdges = Edges.Num() - ProgramPin.FirstEdge;
+	}
+
+	for (const auto& [EntryPointName, InputNode] : Asset->CustomInputs)
+	{
+		if (InputNode != nullptr)
+		{
+			EntryPoints.Add(EntryPointName, InputNode->ProgramIndex);
+		}
+	}
+
+	bIsCompiled = true;
+	UpdateRuntimeTables();
+#else
+	// Pin objects are stripped from cooked builds, programs are compiled when their asset is saved.
+	UE_LOG(LogGameSession, Error, TEXT("%s: game flow program is missing from the cooked asset, resave it"), *GetNameSafe(Asset));
+#endif
+}
+
+void FGameFlowProgram::UpdateStateLayout()
+{
+	StateSize = 0;
+	StateAlignment = 1;
+	bCanShareNodes = Nodes.Num() > 0;
+	LayoutHash = GetTypeHash(Nodes.Num());
+	
+	for (FGameFlowProgramNode& ProgramNode : Nodes)
+	{
+		ProgramNode.StateOffset = INDEX_NONE;
+		LayoutHash = HashCombine(LayoutHash, HashCombine(GetTypeHash(ProgramNode.NumInputs), GetTypeHash(ProgramNode.NumOutputs)));
+		if (ProgramNode.bInlined) continue;
+		
+		const UGameFlowNode* Node = ProgramNode.Node;
+		if (Node == nullptr)
+		{
+			bCanShareNodes = false;
+			continue;
+		}
+
+		// Blueprint nodes may always add state to the node object.
+		bCanShareNodes &= Node->CanBeSharedBetweenInstances()
+			&& !Node->GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint);
+		
+		// Names hash differently between runs, hash their text instead.
+		LayoutHash = HashCombine(LayoutHash, FCrc::StrCrc32(*Node->GetClass()->GetName()));
+		
+		const UScriptStruct* StateStruct = Node->GetInstanceStateStruct();
+		if (StateStruct != nullptr)
+		{
+			LayoutHash = HashCombine(LayoutHash, FCrc::StrCrc32(*StateStruct->GetName()));
+			const int32 Alignment = StateStruct->GetMinAlignment();
+			ProgramNode.StateOffset = Align(StateSize, Alignment);
+			StateSize = ProgramNode.StateOffset + StateStruct->GetStructureSize();
+			StateAlignment = FMath::Max(StateAlignment, Alignment);
+		}
+	}
+}
+
+void FGameFlowProgram::UpdateRuntimeTables()
+{
+	UpdateStateLayout();
+	UpdatePreloadTable();
+	UpdatePrefetchTable();
+}
+
+void FGameFlowProgram::CopyLoadingTables(const FGameFlowProgram& Other)
+{
+	if (!ensure(Nodes.Num() == Other.Nodes.Num())) return;
+
+	PreloadTargets = Other.PreloadTargets;
+	InitialPreloads = Other.InitialPreloads;
+	PrefetchTargets = Other.PrefetchTargets;
+	PrefetchPaths = Other.PrefetchPaths;
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+		const FGameFlowProgramNode& OtherNode = Other.Nodes[NodeIndex];
+		ProgramNode.FirstPreload = OtherNode.FirstPreload;
+		ProgramNode.NumPreload = OtherNode.NumPreload;
+		ProgramNode.FirstPrefetch = OtherNode.FirstPrefetch;
+		ProgramNode.NumPrefetch = OtherNode.NumPrefetch;
+		ProgramNode.FirstPrefetchPath = OtherNode.FirstPrefetchPath;
+		ProgramNode.NumPrefetchPaths = OtherNode.NumPrefetchPaths;
+	}
+}
+
+void FGameFlowProgram::UpdatePreloadTable()
+{
+	PreloadTargets.Reset();
+	InitialPreloads.Reset();
+	for (FGameFlowProgramNode& ProgramNode : Nodes)
+	{
+		ProgramNode.FirstPreload = 0;
+		ProgramNode.NumPreload = 0;
+	}
+
+	TArray<int32> PreloadNodes;
+	TBitArray<> IsPreloadNode(false, Nodes.Num());
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		const UGameFlowNode* Node = Nodes[NodeIndex].Node;
+		if (Node != nullptr && !Nodes[NodeIndex].bInlined && Node->NeedsPreload())
+		{
+			PreloadNodes.Add(NodeIndex);
+			IsPreloadNode[NodeIndex] = true;
+		}
+	}
+	if (PreloadNodes.Num() == 0) return;
+	
+	const int32 MaxHops = UGameFlowRuntimeSettings::Get()->SubgraphPreloadHops;
+	if (MaxHops < 0)
+	{
+		InitialPreloads = MoveTemp(PreloadNodes);
+		return;
+	}
+	// Nodes reached by execution load their content by themselves.
+	if (MaxHops == 0) return;
+
+	// Collect the nodes to preload within reach of each node, excluding the node itself.
+	TArray<int32> ReachableNodes;
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+		ProgramNode.FirstPreload = PreloadTargets.Num();
+		
+		CollectReachableNodes(NodeIndex, MaxHops, ReachableNodes);
+		for (int32 Index = 1; Index < ReachableNodes.Num(); ++Index)
+		{
+			if (IsPreloadNode[ReachableNodes[Index]])
+			{
+				PreloadTargets.Add(ReachableNodes[Index]);
+			}
+		}
+		ProgramNode.NumPreload = PreloadTargets.Num() - ProgramNode.FirstPreload;
+	}
+}
+
+void FGameFlowProgram::UpdatePrefetchTable()
+{
+	PrefetchTargets.Reset();
+	PrefetchPaths.Reset();
+	
+	const int32 MaxHops = UGameFlowRuntimeSettings::Get()->AssetPrefetchHops;
+	TBitArray<> IsPrefetchNode(false, Nodes.Num());
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+		ProgramNode.FirstPrefetchPath = PrefetchPaths.Num();
+		if (MaxHops > 0 && ProgramNode.Node != nullptr && !ProgramNode.bInlined)
+		{
+			ProgramNode.Node->GetPrefetchAssets(PrefetchPaths);
+		}
+		ProgramNode.NumPrefetchPaths = PrefetchPaths.Num() - ProgramNode.FirstPrefetchPath;
+		IsPrefetchNode[NodeIndex] = ProgramNode.NumPrefetchPaths > 0;
+	}
+
+	// Collect the nodes referencing assets within reach of each node, the node itself included.
+	const bool bHasPrefetchNodes = IsPrefetchNode.Find(true) != INDEX_NONE;
+	TArray<int32> ReachableNodes;
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+		ProgramNode.FirstPrefetch = PrefetchTargets.Num();
+		if (bHasPrefetchNodes)
+		{
+			CollectReachableNodes(NodeIndex, MaxHops, ReachableNodes);
+			for (const int32 ReachableNode : ReachableNodes)
+			{
+				if (IsPrefetchNode[ReachableNode])
+				{
+					PrefetchTargets.Add(ReachableNode);
+				}
+			}
+		}
+		ProgramNode.NumPrefetch = PrefetchTargets.Num() - ProgramNode.FirstPrefetch;
+	}
+}
+
+void FGameFlowProgram::CollectReachableNodes(int32 NodeIndex, int32 MaxHops, TArray<int32>& OutNodes) const
+{
+	// Walk the edges breadth-first, one hop at a time.
+	OutNodes.Reset();
+	OutNodes.Add(NodeIndex);
+	TBitArray<> Visited(false, Nodes.Num());
+	Visited[NodeIndex] = true;
+	
+	int32 FrontierStart = 0;
+	for (int32 Hop = 0; Hop < MaxHops && FrontierStart < OutNodes.Num(); ++Hop)
+	{
+		const int32 FrontierEnd = OutNodes.Num();
+		for (int32 FrontierIndex = FrontierStart; FrontierIndex < FrontierEnd; ++FrontierIndex)
+		{
+			const FGameFlowProgramNode& FrontierNode = Nodes[OutNodes[FrontierIndex]];
+			const int32 LastOutput = FrontierNode.FirstOutput + FrontierNode.NumOutputs;
+			for (int32 PinIndex = FrontierNode.FirstOutput; PinIndex < LastOutput; ++PinIndex)
+			{
+				const FGameFlowProgramPin& OutputPin = OutputPins[PinIndex];
+				for (int32 EdgeIndex = OutputPin.FirstEdge; EdgeIndex < OutputPin.FirstEdge + OutputPin.NumEdges; ++EdgeIndex)
+				{
+					const int32 ConnectedNode = InputPins[Edges[EdgeIndex]].NodeIndex;
+					if (!Visited[ConnectedNode])
+					{
+						Visited[ConnectedNode] = true;
+						OutNodes.Add(ConnectedNode);
+					}
+				}
+			}
+		}
+		FrontierStart = FrontierEnd;
+	}
+}
+
+void FGameFlowProgram::Reset()
+{
+	Nodes.Reset();
+	InputPins.Reset();
+	OutputPins.Reset();
+	Edges.Reset();
+	EntryPoints.Reset();
+	NodeSources.Reset();
+	PreloadTargets.Reset();
+	InitialPreloads.Reset();
+	PrefetchTargets.Reset();
+	PrefetchPaths.Reset();
+	bIsCompiled = false;
+	StateSize = 0;
+	StateAlignment = 1;
+	bCanShareNodes = false;
+	LayoutHash = 0;
+}
+
+SIZE_T FGameFlowProgram::GetAllocatedSize() const
+{
+	return Nodes.GetAllocatedSize() + InputPins.GetAllocatedSize() + OutputPins.GetAllocatedSize() + Edges.GetAllocatedSize()
+		+ EntryPoints.GetAllocatedSize() + NodeSources.GetAllocatedSize() + PreloadTargets.GetAllocatedSize()
+		+ InitialPreloads.GetAllocatedSize() + PrefetchTargets.GetAllocatedSize() + PrefetchPaths.GetAllocatedSize();
+}
+
+const FGameFlowProgramNodeSource* FGameFlowProgram::GetNodeSource(int32 NodeIndex) const
+{
+	return NodeSources.IsValidIndex(NodeIndex) && !NodeSources[NodeIndex].Asset.IsNull()? &NodeSources[NodeIndex] : nullptr;
+}
+
+int32 FGameFlowProgram::FindOutputPin(int32 NodeIndex, FName PinName) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex)) return INDEX_NONE;
+
+	const FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+	for (int32 PinIndex = ProgramNode.FirstOutput; PinIndex < ProgramNode.FirstOutput + ProgramNode.NumOutputs; ++PinIndex)
+	{
+		if (OutputPins[PinIndex].PinName == PinName)
+		{
+			return PinIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 FGameFlowProgram::FindInputPin(int32 NodeIndex, FName PinName) const
+{
+	if (!Nodes.IsValidIndex(NodeIndex)) return INDEX_NONE;
+
+	const FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+	for (int32 PinIndex = ProgramNode.FirstInput; PinIndex < ProgramNode.FirstInput + ProgramNode.NumInputs; ++PinIndex)
+	{
+		if (InputPins[PinIndex].PinName == PinName)
+		{
+			return PinIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+#if WITH_EDITOR
+
+bool FGameFlowProgram::InlineSubgraphs(UGameFlowAsset* Owner, TArray<UGameFlowNode*>& OutDuplicatedNodes)
+{
+	// Flattening twice would duplicate the subgraph nodes once more.
+	if (NodeSources.Num() > 0 || Nodes.ContainsByPredicate([](const FGameFlowProgramNode& ProgramNode) { return ProgramNode.bInlined; }))
+	{
+		return false;
+	}
+	
+	TArray<const UGameFlowAsset*> AssetStack = { Owner };
+	if (!InlineSubgraphsRecursive(AssetStack)) return false;
+
+	// Runtime nodes coming from subgraphs have to be owned by this asset, as they carry
+	// their index inside this program. Flattened nodes are dropped with their references.
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		FGameFlowProgramNode& ProgramNode = Nodes[NodeIndex];
+		UGameFlowNode* Node = ProgramNode.Node;
+		if (Node == nullptr) continue;
+		
+		if (ProgramNode.bInlined)
+		{
+			ProgramNode.Node = nullptr;
+			continue;
+		}
+		
+		if (Node->GetTypedOuter<UGameFlowAsset>() != Owner)
+		{
+			const FName NodeName = MakeUniqueObjectName(Owner, Node->GetClass(), Node->GetFName());
+			Node = DuplicateObject(Node, Owner, NodeName);
+			// Connections have been compiled already, and would reference the subgraph package.
+			for (const auto& [PinName, PinHandle] : Node->Inputs)
+			{
+				if (PinHandle != nullptr) PinHandle->ResetConnections();
+			}
+			for (const auto& [PinName, PinHandle] : Node->Outputs)
+			{
+				if (PinHandle != nullptr) PinHandle->ResetConnections();
+			}
+			ProgramNode.Node = Node;
+			OutDuplicatedNodes.Add(Node);
+		}
+		Node->ProgramIndex = NodeIndex;
+	}
+
+	UpdateRuntimeTables();
+	return true;
+}
+
+bool FGameFlowProgram::InlineSubgraphsRecursive(TArray<const UGameFlowAsset*>& AssetStack)
+{
+	// Input pins which are subgraph boundaries, mapped to the output pin execution continues from.
+	// INDEX_NONE means execution stops at the boundary.
+	TMap<int32, int32> ForwardedPins;
+	
+	const int32 NumOwnNodes = Nodes.Num();
+	for (int32 SubgraphNodeIndex = 0; SubgraphNodeIndex < NumOwnNodes; ++SubgraphNodeIndex)
+	{
+		const UGameFlowNode_FlowControl_Subgraph* SubgraphNode = Cast<UGameFlowNode_FlowControl_Subgraph>(Nodes[SubgraphNodeIndex].Node);
+		if (SubgraphNode == nullptr || Nodes[SubgraphNodeIndex].bInlined) continue;
+
+		UGameFlowAsset* SubgraphAsset = SubgraphNode->Asset.LoadSynchronous();
+		if (SubgraphAsset == nullptr) continue;
+		if (AssetStack.Contains(SubgraphAsset))
+		{
+			UE_LOG(LogGameSession, Warning, TEXT("%s: recursive subgraph %s will not be inlined"),
+				*AssetStack[0]->GetName(), *SubgraphAsset->GetName());
+			continue;
+		}
+
+		if (!SubgraphAsset->GetProgram().IsCompiled())
+		{
+			SubgraphAsset->CompileProgram();
+		}
+		FGameFlowProgram SubProgram = SubgraphAsset->GetProgram();
+		AssetStack.Push(SubgraphAsset);
+		SubProgram.InlineSubgraphsRecursive(AssetStack);
+		AssetStack.Pop();
+
+		const int32 NodeOffset = Nodes.Num();
+		const int32 InputOffset = InputPins.Num();
+		const int32 OutputOffset = OutputPins.Num();
+		const int32 EdgeOffset = Edges.Num();
+
+		// Append the subgraph tables, moving their indices past the ones of this program.
+		if (NodeSources.Num() < NodeOffset)
+		{
+			NodeSources.SetNum(NodeOffset);
+		}
+		for (int32 NodeIndex = 0; NodeIndex < SubProgram.Nodes.Num(); ++NodeIndex)
+		{
+			FGameFlowProgramNode& ProgramNode = Nodes.Add_GetRef(SubProgram.Nodes[NodeIndex]);
+			ProgramNode.FirstInput += InputOffset;
+			ProgramNode.FirstOutput += OutputOffset;
+
+			const FGameFlowProgramNodeSource* NestedSource = SubProgram.GetNodeSource(NodeIndex);
+			FGameFlowProgramNodeSource& NodeSource = NodeSources.AddDefaulted_GetRef();
+			if (NestedSource != nullptr)
+			{
+				NodeSource = *NestedSource;
+				NodeSource.SubgraphNodeIndex += NodeOffset;
+			}
+			else
+			{
+				NodeSource.Asset = SubgraphAsset;
+				NodeSource.NodeName = ProgramNode.Node != nullptr? ProgramNode.Node->GetFName() : NAME_None;
+				NodeSource.SubgraphNodeIndex = SubgraphNodeIndex;
+			}
+		}
+		for (const FGameFlowProgramPin& SubPin : SubProgram.InputPins)
+		{
+			InputPins.Add_GetRef(SubPin).NodeIndex += NodeOffset;
+		}
+		for (const FGameFlowProgramPin& SubPin : SubProgram.OutputPins)
+		{
+			FGameFlowProgramPin& ProgramPin = OutputPins.Add_GetRef(SubPin);
+			ProgramPin.NodeIndex += NodeOffset;
+			ProgramPin.FirstEdge += EdgeOffset;
+		}
+		for (const int32 SubEdge : SubProgram.Edges)
+		{
+			Edges.Add(SubEdge + InputOffset);
+		}
+
+		// Subgraph node inputs continue from the matching subgraph entry point outputs.
+		const FGameFlowProgramNode& SubgraphEntry = Nodes[SubgraphNodeIndex];
+		for (int32 PinIndex = SubgraphEntry.FirstInput; PinIndex < SubgraphEntry.FirstInput + SubgraphEntry.NumInputs; ++PinIndex)
+		{
+			const int32* EntryNodeIndex = SubProgram.EntryPoints.Find(InputPins[PinIndex].PinName);
+			const int32 EntryOutput = EntryNodeIndex != nullptr && SubProgram.Nodes[*EntryNodeIndex].NumOutputs > 0
+				? SubProgram.Nodes[*EntryNodeIndex].FirstOutput + OutputOffset : INDEX_NONE;
+			ForwardedPins.Add(PinIndex, EntryOutput);
+		}
+		for (const auto& [EntryPointName, EntryNodeIndex] : SubProgram.EntryPoints)
+		{
+			Nodes[EntryNodeIndex + NodeOffset].bInlined = true;
+		}
+
+		// Subgraph exit points continue from the matching subgraph node outputs.
+		for (const auto& [ExitPointName, OutputNode] : SubgraphAsset->CustomOutputs)
+		{
+			const int32 ExitNodeIndex = OutputNode != nullptr? OutputNode->GetProgramIndex() : INDEX_NONE;
+			if (!SubProgram.Nodes.IsValidIndex(ExitNodeIndex) || SubProgram.Nodes[ExitNodeIndex].Node != OutputNode) continue;
+
+			FGameFlowProgramNode& ExitNode = Nodes[ExitNodeIndex + NodeOffset];
+			ExitNode.bInlined = true;
+			const int32 ExitOutput = FindOutputPin(SubgraphNodeIndex, ExitPointName);
+			for (int32 PinIndex = ExitNode.FirstInput; PinIndex < ExitNode.FirstInput + ExitNode.NumInputs; ++PinIndex)
+			{
+				ForwardedPins.Add(PinIndex, ExitOutput);
+			}
+		}
+
+		Nodes[SubgraphNodeIndex].bInlined = true;
+	}
+
+	if (ForwardedPins.Num() == 0) return false;
+
+	// Rebuild the edges table, connecting output pins straight to the pins past the subgraph boundaries.
+	const TArray<int32> InlinedEdges = MoveTemp(Edges);
+	const int32 MaxDepth = Nodes.Num();
+	TFunction<void(int32, int32)> AddEdge = [&](int32 InputPinIndex, int32 Depth)
+	{
+		const int32* ForwardedOutput = ForwardedPins.Find(InputPinIndex);
+		if (ForwardedOutput == nullptr)
+		{
+			Edges.Add(InputPinIndex);
+			return;
+		}
+		// Boundaries leading nowhere, or looping on themselves, end the execution.
+		if (*ForwardedOutput == INDEX_NONE || Depth >= MaxDepth) return;
+
+		const FGameFlowProgramPin& OutputPin = OutputPins[*ForwardedOutput];
+		for (int32 EdgeIndex = OutputPin.FirstEdge; EdgeIndex < OutputPin.FirstEdge + OutputPin.NumEdges; ++EdgeIndex)
+		{
+			AddEdge(InlinedEdges[EdgeIndex], Depth + 1);
+		}
+	};
+
+	TArray<int32> FirstEdges;
+	FirstEdges.Reserve(OutputPins.Num());
+	for (FGameFlowProgramPin& ProgramPin : OutputPins)
+	{
+		FirstEdges.Add(Edges.Num());
+		for (int32 EdgeIndex = ProgramPin.FirstEdge; EdgeIndex < ProgramPin.FirstEdge + ProgramPin.NumEdges; ++EdgeIndex)
+		{
+			AddEdge(InlinedEdges[EdgeIndex], 0);
+		}
+	}
+	// Old ranges are read while expanding, update them only once all the edges have been rebuilt.
+	for (int32 PinIndex = 0; PinIndex < OutputPins.Num(); ++PinIndex)
+	{
+		FGameFlowProgramPin& ProgramPin = OutputPins[PinIndex];
+		const int32 LastEdge = PinIndex + 1 < FirstEdges.Num()? FirstEdges[PinIndex + 1] : Edges.Num();
+		ProgramPin.FirstEdge = FirstEdges[PinIndex];
+		ProgramPin.NumEdges = LastEdge - ProgramPin.FirstEdge;
+	}
+
+	NodeSources.SetNum(Nodes.Num());
+	return true;
+}
+
+#endif
@@ -0,0 +1,140 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowScheduler.h"
+#include "GameFlowAsset.h"
+#include "Config/GameFlowRuntimeSettings.h"
+#include "GameFramework/GameSession.h"
+
+void FGameFlowScheduler::Run(UGameFlowAsset* Instance)
+{
+	BeginFrameIfNeeded();
+
+	// Waiting instances keep their place in the queue, new work will run when they are resumed.
+	if (Instance->bIsScheduled) return;
+	
+	if (IsOutOfBudget(Instance->Priority) || !Drain(Instance))
+	{
+		Schedule(Instance);
+	}
+}
+
+void FGameFlowScheduler::Tick()
+{
+	BeginFrameIfNeeded();
+
+	for (int32 Priority = 0; Priority < static_cast<int32>(EGameFlowPriority::Num); ++Priority)
+	{
+		TArray<TWeakObjectPtr<UGameFlowAsset>>& Queue = WaitingInstances[Priority];
+		int32 Index = 0;
+		while (Index < Queue.Num())
+		{
+			// Lower priorities will not have any budget left either.
+			if (IsOutOfBudget(static_cast<EGameFlowPriority>(Priority))) return;
+
+			UGameFlowAsset* Instance = Queue[Index].Get();
+			if (Instance == nullptr || Drain(Instance))
+			{
+				if (Instance != nullptr)
+				{
+					Instance->bIsScheduled = false;
+				}
+				Queue.RemoveAt(Index);
+			}
+			else
+			{
+				++Index;
+			}
+		}
+	}
+}
+
+void FGameFlowScheduler::Unschedule(UGameFlowAsset* Instance)
+{
+	if (!Instance->bIsScheduled) return;
+
+	// Clear the entry rather than removing it, the queue may be iterated by Tick, which drops cleared entries.
+	Instance->bIsScheduled = false;
+	for (TArray<TWeakObjectPtr<UGameFlowAsset>>& Queue : WaitingInstances)
+	{
+		for (TWeakObjectPtr<UGameFlowAsset>& WeakInstance : Queue)
+		{
+			if (WeakInstance == Instance)
+			{
+				WeakInstance.Reset();
+			}
+		}
+	}
+}
+
+bool FGameFlowScheduler::HasPendingWork() const
+{
+	for (const TArray<TWeakObjectPtr<UGameFlowAsset>>& Queue : WaitingInstances)
+	{
+		if (Queue.Num() > 0) return true;
+	}
+	return false;
+}
+
+void FGameFlowScheduler::BeginFrameIfNeeded()
+{
+	if (CurrentFrame == GFrameCounter) return;
+
+	// Whatever is still waiting has been carried over from the previous frame.
+	CurrentFrameStats.DeferredActivations = 0;
+	CurrentFrameStats.DeferredInstances = 0;
+	for (const TArray<TWeakObjectPtr<UGameFlowAsset>>& Queue : WaitingInstances)
+	{
+		for (const TWeakObjectPtr<UGameFlowAsset>& WeakInstance : Queue)
+		{
+			const UGameFlowAsset* Instance = WeakInstance.Get();
+			if (Instance != nullptr)
+			{
+				CurrentFrameStats.DeferredActivations += Instance->WorkQueue.Num();
+				CurrentFrameStats.DeferredInstances++;
+			}
+		}
+	}
+	CurrentFrameStats.TimeSpentMs = static_cast<float>(FrameTimeSpent * 1000.0);
+	
+	if (CurrentFrameStats.DeferredActivations > 0)
+	{
+		UE_LOG(LogGameSession, Verbose, TEXT("Game flow scheduler deferred %d node activations of %d instances to the next frame."),
+			CurrentFrameStats.DeferredActivations, CurrentFrameStats.DeferredInstances);
+	}
+	
+	LastFrameStats = CurrentFrameStats;
+	CurrentFrameStats = FGameFlowSchedulerStats();
+	CurrentFrame = GFrameCounter;
+	FrameTimeSpent = 0.0;
+	FrameBudget = UGameFlowRuntimeSettings::Get()->FrameBudgetMs / 1000.0;
+}
+
+void FGameFlowScheduler::Schedule(UGameFlowAsset* Instance)
+{
+	Instance->bIsScheduled = true;
+	WaitingInstances[static_cast<int32>(Instance->Priority)].Add(Instance);
+}
+
+bool FGameFlowScheduler::Drain(UGameFlowAsset* Instance)
+{
+	// Nodes may run other instances work queues, e.g. subgraphs. Nested drains share the
+	// deadline of the outermost one, which alone accounts the time spent.
+	if (DrainDepth++ == 0)
+	{
+		DrainStartTime = FPlatformTime::Seconds();
+	}
+	const bool bIsBudgeted = FrameBudget > 0.0 && Instance->Priority != EGameFlowPriority::Critical;
+	const double Deadline = bIsBudgeted? DrainStartTime + FrameBudget - FrameTimeSpent : 0.0;
+	
+	const bool bDrained = Instance->DrainWorkQueue(Deadline, CurrentFrameStats.ExecutedActivations);
+	if (--DrainDepth == 0)
+	{
+		FrameTimeSpent += FPlatformTime::Seconds() - DrainStartTime;
+	}
+	return bDrained;
+}
+
+bool FGameFlowScheduler::IsOutOfBudget(EGameFlowPriority Priority) const
+{
+	return Priority != EGameFlowPriority::Critical && FrameBudget > 0.0 && FrameTimeSpent >= FrameBudget;
+}
@@ -0,0 +1,491 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowTimingWheel.h"
+#include "Execution/GameFlowInstanceState.h"
+#include "GameFlowAsset.h"
+#include "Nodes/GameFlowNode.h"
+
+FGameFlowTimingWheel::FGameFlowTimingWheel(double InResolution)
+	: Resolution(FMath::Max(InResolution, UE_KINDA_SMALL_NUMBER))
+{
+	for (int32& SlotHead : Slots)
+	{
+		SlotHead = INDEX_NONE;
+	}
+}
+
+FGameFlowTimerHandle FGameFlowTimingWheel::SetTimer(UGameFlowAsset* Instance, UGameFlowNode* Node, int32 Payload,
+	float Interval, bool bLoop)
+{
+	if (Instance == nullptr || Node == nullptr) return FGameFlowTimerHandle();
+
+	const int32 TimerIndex = AllocateTimer();
+	FTimer& Timer = Timers[TimerIndex];
+	Timer.Instance = Instance;
+	Timer.Node = Node;
+	Timer.Payload = Payload;
+	Timer.Interval = Interval;
+	Timer.bLoop = bLoop;
+	Timer.bUserPaused = false;
+
+	// Link the timer to its instance, so that it follows the instance clock.
+	FInstanceClock& Clock = Clocks.FindOrAdd(Instance);
+	Timer.InstancePrev = INDEX_NONE;
+	Timer.InstanceNext = Clock.FirstTimer;
+	if (Clock.FirstTimer != INDEX_NONE)
+	{
+		Timers[Clock.FirstTimer].InstancePrev = TimerIndex;
+	}
+	Clock.FirstTimer = TimerIndex;
+	
+	ScheduleIn(TimerIndex, Interval, Clock);
+	return FGameFlowTimerHandle(TimerIndex, Timer.Generation);
+}
+
+void FGameFlowTimingWheel::ClearTimer(FGameFlowTimerHandle& Handle)
+{
+	if (FindTimer(Handle) != nullptr)
+	{
+		FreeTimer(Handle.GetIndex());
+	}
+	Handle.Invalidate();
+}
+
+void FGameFlowTimingWheel::ClearAllTimers(const UGameFlowAsset* Instance)
+{
+	const FInstanceClock* Clock = Clocks.Find(Instance);
+	if (Clock == nullptr) return;
+
+	// Freeing the last timer of the instance would remove its clock, make sure we don't read it afterward.
+	int32 TimerIndex = Clock->FirstTimer;
+	while (TimerIndex != INDEX_NONE)
+	{
+		const int32 NextTimer = Timers[TimerIndex].InstanceNext;
+		FreeTimer(TimerIndex);
+		TimerIndex = NextTimer;
+	}
+	Clocks.Remove(Instance);
+}
+
+bool FGameFlowTimingWheel::HasRunningTimers(const UGameFlowAsset* Instance) const
+{
+	if (bIsPaused) return false;
+	
+	const FInstanceClock* Clock = Clocks.Find(Instance);
+	return Clock != nullptr && !Clock->bPaused && Clock->FirstTimer != INDEX_NONE;
+}
+
+void FGameFlowTimingWheel::PauseTimer(FGameFlowTimerHandle Handle)
+{
+	FTimer* Timer = FindTimer(Handle);
+	if (Timer == nullptr || Timer->bUserPaused) return;
+
+	Timer->bUserPaused = true;
+	if (Timer->State == ETimerState::Scheduled)
+	{
+		Timer->Remaining = GetRemaining(*Timer, Clocks.FindChecked(Timer->Instance));
+		Unlink(Handle.GetIndex());
+		Timer->State = ETimerState::Paused;
+	}
+}
+
+void FGameFlowTimingWheel::UnPauseTimer(FGameFlowTimerHandle Handle)
+{
+	FTimer* Timer = FindTimer(Handle);
+	if (Timer == nullptr || !Timer->bUserPaused) return;
+
+	Timer->bUserPaused = false;
+	if (Timer->State == ETimerState::Paused)
+	{
+		ScheduleIn(Handle.GetIndex(), Timer->Remaining, Clocks.FindChecked(Timer->Instance));
+	}
+}
+
+bool FGameFlowTimingWheel::IsTimerActive(FGameFlowTimerHandle Handle) const
+{
+	const FTimer* Timer = FindTimer(Handle);
+	return Timer != nullptr && Timer->State != ETimerState::Paused;
+}
+
+bool FGameFlowTimingWheel::IsTimerPaused(FGameFlowTimerHandle Handle) const
+{
+	const FTimer* Timer = FindTimer(Handle);
+	return Timer != nullptr && Timer->State == ETimerState::Paused;
+}
+
+float FGameFlowTimingWheel::GetTimerElapsed(FGameFlowTimerHandle Handle) const
+{
+	const FTimer* Timer = FindTimer(Handle);
+	if (Timer == nullptr) return -1.f;
+	
+	return Timer->Interval - GetRemaining(*Timer, Clocks.FindChecked(Timer->Instance));
+}
+
+void FGameFlowTimingWheel::SerializeTimer(FArchive& Ar, FGameFlowTimerHandle& Handle, UGameFlowAsset* Instance, UGameFlowNode* Node)
+{
+	const FTimer* Timer = Ar.IsSaving()? FindTimer(Handle) : nullptr;
+	bool bHasTimer = Timer != nullptr;
+	Ar << bHasTimer;
+	if (!bHasTimer)
+	{
+		Handle.Invalidate();
+		return;
+	}
+
+	int32 Payload = 0;
+	float Interval = 0.f;
+	float Remaining = 0.f;
+	bool bLoop = false;
+	bool bUserPaused = false;
+	if (Ar.IsSaving())
+	{
+		Payload = Timer->Payload;
+		Interval = Timer->Interval;
+		Remaining = Timer->State == ETimerState::Expiring? 0.f : GetRemaining(*Timer, Clocks.FindChecked(Timer->Instance));
+		bLoop = Timer->bLoop;
+		bUserPaused = Timer->bUserPaused;
+	}
+	Ar << Payload << Interval << Remaining << bLoop << bUserPaused;
+
+	if (Ar.IsLoading())
+	{
+		Handle = SetTimer(Instance, Node, Payload, Remaining, bLoop);
+		FTimer* RestoredTimer = FindTimer(Handle);
+		if (RestoredTimer != nullptr)
+		{
+			// Loops restart from the full interval.
+			RestoredTimer->Interval = Interval;
+			if (bUserPaused)
+			{
+				PauseTimer(Handle);
+			}
+		}
+	}
+}
+
+void FGameFlowTimingWheel::SetInstancePaused(UGameFlowAsset* Instance, bool bPaused)
+{
+	FInstanceClock& Clock = Clocks.FindOrAdd(Instance);
+	if (Clock.bPaused == bPaused) return;
+
+	if (bPaused)
+	{
+		Suspend(Clock);
+		Clock.bPaused = true;
+	}
+	else
+	{
+		Clock.bPaused = false;
+		Resume(Clock);
+	}
+}
+
+void FGameFlowTimingWheel::SetInstanceTimeDilation(UGameFlowAsset* Instance, float TimeDilation)
+{
+	FInstanceClock& Clock = Clocks.FindOrAdd(Instance);
+	
+	// Remaining time is measured in instance local time, which does not change with dilation.
+	Suspend(Clock);
+	Clock.TimeDilation = FMath::Max(TimeDilation, 0.f);
+	Resume(Clock);
+}
+
+void FGameFlowTimingWheel::Advance(float DeltaTime)
+{
+	if (bIsPaused || NumScheduled == 0)
+	{
+		Accumulator = 0.0;
+		return;
+	}
+
+	Accumulator += DeltaTime;
+	const int64 NumSteps = FMath::FloorToInt64(Accumulator / Resolution);
+	Accumulator -= NumSteps * Resolution;
+	
+	for (int64 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+	{
+		// Nothing left to expire, just move the wheel forward.
+		if (NumScheduled == 0)
+		{
+			CurrentTick += NumSteps - StepIndex;
+			break;
+		}
+		
+		Step();
+		FireExpired();
+	}
+}
+
+FGameFlowTimingWheel::FTimer* FGameFlowTimingWheel::FindTimer(FGameFlowTimerHandle Handle)
+{
+	if (!Timers.IsValidIndex(Handle.GetIndex())) return nullptr;
+
+	FTimer& Timer = Timers[Handle.GetIndex()];
+	return Timer.Generation == Handle.GetGeneration() && Timer.State != ETimerState::Free? &Timer : nullptr;
+}
+
+const FGameFlowTimingWheel::FTimer* FGameFlowTimingWheel::FindTimer(FGameFlowTimerHandle Handle) const
+{
+	return const_cast<FGameFlowTimingWheel*>(this)->FindTimer(Handle);
+}
+
+int32 FGameFlowTimingWheel::AllocateTimer()
+{
+	if (FirstFreeTimer != INDEX_NONE)
+	{
+		const int32 TimerIndex = FirstFreeTimer;
+		FirstFreeTimer = Timers[TimerIndex].Next;
+		return TimerIndex;
+	}
+	return Timers.AddDefaulted();
+}
+
+void FGameFlowTimingWheel::FreeTimer(int32 TimerIndex)
+{
+	FTimer& Timer = Timers[TimerIndex];
+	if (Timer.State == ETimerState::Scheduled)
+	{
+		Unlink(TimerIndex);
+	}
+
+	// Unlink the timer from its instance, forgetting the clock once it has nothing left to drive.
+	FInstanceClock* Clock = Clocks.Find(Timer.Instance);
+	if (Clock != nullptr)
+	{
+		if (Timer.InstancePrev != INDEX_NONE)
+		{
+			Timers[Timer.InstancePrev].InstanceNext = Timer.InstanceNext;
+		}
+		else
+		{
+			Clock->FirstTimer = Timer.InstanceNext;
+		}
+		
+		if (Timer.InstanceNext != INDEX_NONE)
+		{
+			Timers[Timer.InstanceNext].InstancePrev = Timer.InstancePrev;
+		}
+
+		if (Clock->FirstTimer == INDEX_NONE && !Clock->bPaused && Clock->TimeDilation == 1.f)
+		{
+			Clocks.Remove(Timer.Instance);
+		}
+	}
+
+	Timer.State = ETimerState::Free;
+	Timer.Generation++;
+	Timer.Instance = nullptr;
+	Timer.Node = nullptr;
+	Timer.InstancePrev = INDEX_NONE;
+	Timer.InstanceNext = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = FirstFreeTimer;
+	FirstFreeTimer = TimerIndex;
+}
+
+void FGameFlowTimingWheel::Insert(int32 TimerIndex)
+{
+	FTimer& Timer = Timers[TimerIndex];
+	
+	// Timers always expire in the future, at least on the next tick.
+	Timer.ExpireTick = FMath::Max(Timer.ExpireTick, CurrentTick + 1);
+	const int64 Delta = Timer.ExpireTick - CurrentTick;
+
+	// Pick the first level whose span covers the timer, timers beyond the last
+	// level are stored at its far end and cascaded again when reached.
+	int32 Level = 0;
+	while (Level < NumLevels - 1 && Delta >= (int64(1) << (SlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+	const int64 MaxDelta = (int64(1) << (SlotBits * NumLevels)) - 1;
+	const int64 SlotTick = CurrentTick + FMath::Min(Delta, MaxDelta);
+	Link(TimerIndex, Level * NumSlots + static_cast<int32>((SlotTick >> (SlotBits * Level)) & SlotMask));
+}
+
+void FGameFlowTimingWheel::Link(int32 TimerIndex, int32 Slot)
+{
+	FTimer& Timer = Timers[TimerIndex];
+	Timer.State = ETimerState::Scheduled;
+	Timer.Slot = Slot;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = Slots[Slot];
+	if (Slots[Slot] != INDEX_NONE)
+	{
+		Timers[Slots[Slot]].Prev = TimerIndex;
+	}
+	Slots[Slot] = TimerIndex;
+	NumScheduled++;
+}
+
+void FGameFlowTimingWheel::Unlink(int32 TimerIndex)
+{
+	FTimer& Timer = Timers[TimerIndex];
+	if (Timer.Prev != INDEX_NONE)
+	{
+		Timers[Timer.Prev].Next = Timer.Next;
+	}
+	else
+	{
+		Slots[Timer.Slot] = Timer.Next;
+	}
+	
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Prev = Timer.Prev;
+	}
+	
+	Timer.Slot = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+	NumScheduled--;
+}
+
+void FGameFlowTimingWheel::ScheduleIn(int32 TimerIndex, float LocalTime, const FInstanceClock& Clock)
+{
+	FTimer& Timer = Timers[TimerIndex];
+	
+	// Stopped clocks keep their timers out of the wheel.
+	if (Timer.bUserPaused || Clock.bPaused || Clock.TimeDilation <= 0.f)
+	{
+		Timer.State = ETimerState::Paused;
+		Timer.Remaining = LocalTime;
+		return;
+	}
+
+	const double RealTime = LocalTime / Clock.TimeDilation;
+	Timer.ExpireTick = CurrentTick + FMath::CeilToInt64((RealTime + Accumulator) / Resolution);
+	Insert(TimerIndex);
+}
+
+float FGameFlowTimingWheel::GetRemaining(const FTimer& Timer, const FInstanceClock& Clock) const
+{
+	if (Timer.State != ETimerState::Scheduled) return Timer.Remaining;
+
+	const double RealTime = (Timer.ExpireTick - CurrentTick) * Resolution - Accumulator;
+	return static_cast<float>(FMath::Max(RealTime, 0.0) * Clock.TimeDilation);
+}
+
+void FGameFlowTimingWheel::Suspend(const FInstanceClock& Clock)
+{
+	for (int32 TimerIndex = Clock.FirstTimer; TimerIndex != INDEX_NONE; TimerIndex = Timers[TimerIndex].InstanceNext)
+	{
+		FTimer& Timer = Timers[TimerIndex];
+		if (Timer.State == ETimerState::Scheduled)
+		{
+			Timer.Remaining = GetRemaining(Timer, Clock);
+			Unlink(TimerIndex);
+			Timer.State = ETimerState::Paused;
+		}
+	}
+}
+
+void FGameFlowTimingWheel::Resume(const FInstanceClock& Clock)
+{
+	for (int32 TimerIndex = Clock.FirstTimer; TimerIndex != INDEX_NONE; TimerIndex = Timers[TimerIndex].InstanceNext)
+	{
+		if (Timers[TimerIndex].State == ETimerState::Paused)
+		{
+			ScheduleIn(TimerIndex, Timers[TimerIndex].Remaining, Clock);
+		}
+	}
+}
+
+void FGameFlowTimingWheel::Cascade(int32 Level)
+{
+	const int32 Slot = Level * NumSlots + static_cast<int32>((CurrentTick >> (SlotBits * Level)) & SlotMask);
+	
+	int32 TimerIndex = Slots[Slot];
+	Slots[Slot] = INDEX_NONE;
+	while (TimerIndex != INDEX_NONE)
+	{
+		const int32 NextTimer = Timers[TimerIndex].Next;
+		NumScheduled--;
+		// Timers due on this very tick go to the current level 0 slot, which is collected right after
+		// cascading. Inserting them would clamp them to the next tick.
+		if (Timers[TimerIndex].ExpireTick <= CurrentTick)
+		{
+			Link(TimerIndex, static_cast<int32>(CurrentTick & SlotMask));
+		}
+		else
+		{
+			Insert(TimerIndex);
+		}
+		TimerIndex = NextTimer;
+	}
+}
+
+void FGameFlowTimingWheel::Step()
+{
+	++CurrentTick;
+
+	// When lower levels wrap around, move the timers of the reached higher level slots down,
+	// starting from the highest level so that they can cascade through all the levels below.
+	int32 HighestLevel = 0;
+	while (HighestLevel < NumLevels - 1 && (CurrentTick & ((int64(1) << (SlotBits * (HighestLevel + 1))) - 1)) == 0)
+	{
+		++HighestLevel;
+	}
+	for (int32 Level = HighestLevel; Level > 0; --Level)
+	{
+		Cascade(Level);
+	}
+
+	// Collect all the timers expiring on this tick.
+	const int32 Slot = static_cast<int32>(CurrentTick & SlotMask);
+	int32 TimerIndex = Slots[Slot];
+	Slots[Slot] = INDEX_NONE;
+	while (TimerIndex != INDEX_NONE)
+	{
+		FTimer& Timer = Timers[TimerIndex];
+		const int32 NextTimer = Timer.Next;
+		NumScheduled--;
+		
+		if (Timer.ExpireTick <= CurrentTick)
+		{
+			Timer.State = ETimerState::Expiring;
+			Timer.Slot = INDEX_NONE;
+			Timer.Prev = INDEX_NONE;
+			Timer.Next = INDEX_NONE;
+			ExpiredTimers.Emplace(TimerIndex, Timer.Generation);
+		}
+		else
+		{
+			Insert(TimerIndex);
+		}
+		TimerIndex = NextTimer;
+	}
+}
+
+void FGameFlowTimingWheel::FireExpired()
+{
+	for (int32 ExpiredIndex = 0; ExpiredIndex < ExpiredTimers.Num(); ++ExpiredIndex)
+	{
+		const int32 TimerIndex = ExpiredTimers[ExpiredIndex].Key;
+		FTimer& Timer = Timers[TimerIndex];
+		
+		// Timers may have been cleared by the nodes notified before them.
+		if (Timer.Generation != ExpiredTimers[ExpiredIndex].Value || Timer.State != ETimerState::Expiring) continue;
+
+		UGameFlowAsset* Instance = Timer.Instance.ResolveObjectPtr();
+		UGameFlowNode* Node = Timer.Node.Get();
+		const int32 Payload = Timer.Payload;
+		
+		// Reschedule or free the timer before notifying the node, so that it can set or clear it again.
+		if (Instance != nullptr && Node != nullptr && Timer.bLoop)
+		{
+			ScheduleIn(TimerIndex, Timer.Interval, Clocks.FindChecked(Timer.Instance));
+		}
+		else
+		{
+			FreeTimer(TimerIndex);
+		}
+
+		if (Instance != nullptr && Node != nullptr)
+		{
+			FGameFlowInstanceScope InstanceScope(Instance);
+			Node->OnTimerExpired(Payload);
+		}
+	}
+	ExpiredTimers.Reset();
+}
@@ -0,0 +1,78 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Execution/GameFlowWorkQueue.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+void FGameFlowWorkQueue::CommitBatch()
+{
+	if (Batch.Num() == 0) return;
+
+	if (Order == EGameFlowExecutionOrder::DepthFirst)
+	{
+		// Push the batch in reverse order, so that the first triggered
+		// activation will be the first one to be popped from the stack.
+		for (int32 Index = Batch.Num() - 1; Index >= 0; --Index)
+		{
+			Items.Add(Batch[Index]);
+		}
+	}
+	else
+	{
+		Items.Append(Batch);
+	}
+	Batch.Reset();
+}
+
+bool FGameFlowWorkQueue::Pop(FGameFlowActivation& OutActivation)
+{
+	if (Items.Num() - Head == 0) return false;
+
+	if (Order == EGameFlowExecutionOrder::DepthFirst)
+	{
+#if (ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 4) || ENGINE_MAJOR_VERSION >= 6
+		OutActivation = Items.Pop(EAllowShrinking::No);
+#else
+		OutActivation = Items.Pop(false);
+#endif
+	}
+	else
+	{
+		OutActivation = Items[Head++];
+		// Once drained, rewind the queue to reuse the allocated memory.
+		if (Head == Items.Num())
+		{
+			Items.Reset();
+			Head = 0;
+		}
+	}
+	return true;
+}
+
+void FGameFlowWorkQueue::GetPendingActivations(TArray<FGameFlowActivation>& OutActivations) const
+{
+	OutActivations.Reset(Num());
+	if (Order == EGameFlowExecutionOrder::DepthFirst)
+	{
+		// The batch will be committed on top of the stack.
+		OutActivations.Append(Batch);
+		for (int32 Index = Items.Num() - 1; Index >= Head; --Index)
+		{
+			OutActivations.Add(Items[Index]);
+		}
+	}
+	else
+	{
+		for (int32 Index = Head; Index < Items.Num(); ++Index)
+		{
+			OutActivations.Add(Items[Index]);
+		}
+		OutActivations.Append(Batch);
+	}
+}
+
+void FGameFlowWorkQueue::Reset()
+{
+	Items.Reset();
+	Batch.Reset();
+	Head = 0;
+}
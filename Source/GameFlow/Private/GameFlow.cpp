@@ -1,16 +1,23 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GameFlow.h"
+#include "GameFlowTagMask.h"
+#include "GameplayTagsManager.h"
+#include "GameplayTagsModule.h"
 
 #define LOCTEXT_NAMESPACE "FGameFlowModule"
 
 void FGameFlowModule::StartupModule()
 {
-	
+	// Assign the tag mask bits once all the tags are known, and extend them when the tags tree changes (e.g. in the editor).
+	UGameplayTagsManager::CallOrRegister_OnDoneAddingNativeTagsDelegate(
+		FSimpleMulticastDelegate::FDelegate::CreateStatic(&FGameFlowTagMask::BuildTagBits));
+	TagTreeChangedHandle = IGameplayTagsModule::OnGameplayTagTreeChanged.AddStatic(&FGameFlowTagMask::BuildTagBits);
 }
 
 void FGameFlowModule::ShutdownModule()
 {
+	IGameplayTagsModule::OnGameplayTagTreeChanged.Remove(TagTreeChangedHandle);
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 }
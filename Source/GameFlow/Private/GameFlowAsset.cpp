@@ -1,10 +1,84 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "GameFlowAsset.h"
+#include "GameFlowSubsystem.h"
+#include "GameFlowMemory.h"
+#include "GameFlowStats.h"
+#include "Config/GameFlowRuntimeSettings.h"
+#include "TimerManager.h"
+#include "Engine/World.h"
+#include "Execution/GameFlowSnapshot.h"
+#include "GameFramework/GameSession.h"
 #include "Nodes/GameFlowNode_Input.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectSaveContext.h"
+
+namespace
+{
+	void SerializeActivations(FArchive& Ar, TArray<FGameFlowActivation>& Activations)
+	{
+		int32 NumActivations = Activations.Num();
+		Ar << NumActivations;
+		if (Ar.IsLoading())
+		{
+			if (NumActivations < 0 || NumActivations > Ar.TotalSize())
+			{
+				Ar.SetError();
+				return;
+			}
+			Activations.SetNum(NumActivations);
+		}
+		for (FGameFlowActivation& Activation : Activations)
+		{
+			Ar << Activation.NodeIndex << Activation.InputPinIndex;
+		}
+	}
+
+	bool IsValidActivation(const FGameFlowProgram& Program, const FGameFlowActivation& Activation)
+	{
+		return Program.Nodes.IsValidIndex(Activation.NodeIndex) && !Program.Nodes[Activation.NodeIndex].bInlined
+			&& (Activation.InputPinIndex == INDEX_NONE || Program.InputPins.IsValidIndex(Activation.InputPinIndex));
+	}
+
+	/**
+	 * Walk the node states of a snapshot without reading them, checking that each one belongs to a stateful
+	 * node and fits inside the payload. The archive is left where the node states start.
+	 */
+	bool AreValidNodeStates(FArchive& Ar, const FGameFlowProgram& Program)
+	{
+		const int64 StatesOffset = Ar.Tell();
+		int32 NumStates = 0;
+		Ar << NumStates;
+		bool bIsValid = !Ar.IsError() && NumStates >= 0;
+		for (int32 Index = 0; Index < NumStates && bIsValid; ++Index)
+		{
+			int32 NodeIndex = INDEX_NONE;
+			int32 StateSize = 0;
+			Ar << NodeIndex << StateSize;
+			const int64 StateEnd = Ar.Tell() + StateSize;
+			bIsValid = !Ar.IsError() && StateSize >= 0 && StateEnd <= Ar.TotalSize()
+				&& Program.Nodes.IsValidIndex(NodeIndex) && Program.Nodes[NodeIndex].StateOffset != INDEX_NONE;
+			if (bIsValid)
+			{
+				Ar.Seek(StateEnd);
+			}
+		}
+		Ar.Seek(StatesOffset);
+		return bIsValid;
+	}
+}
 
 UGameFlowAsset::UGameFlowAsset()
 {
+	ExecutionOrder = EGameFlowExecutionOrder::DepthFirst;
+	bShareGraphBetweenInstances = true;
+	MaxPooledInstances = 8;
+	Priority = EGameFlowPriority::Normal;
+	bIsRunningWorkQueue = false;
+	bIsScheduled = false;
+	bIsSnapshotDirty = false;
+	
 #if WITH_EDITOR
 	this->bHasAlreadyBeenOpened = false;
 #endif
@@ -12,13 +86,460 @@ UGameFlowAsset::UGameFlowAsset()
 
 void UGameFlowAsset::Execute(FName EntryPointName)
 {
-	UGameFlowNode* RootNode = CustomInputs.FindRef(EntryPointName);
-	if(RootNode != nullptr)
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	if(!IsSharedInstance() && !Program.IsCompiled())
+	{
+		CompileProgram();
+	}
+	if(!InstanceState.IsInitialized())
+	{
+		InitializeInstanceState();
+	}
+	
+	const int32* RootNodeIndex = GetProgram().EntryPoints.Find(EntryPointName);
+	if(RootNodeIndex != nullptr)
+	{
+		if(GetProgram().HasPrefetchPaths())
+		{
+			Prefetcher.Activate(GetProgram(), *RootNodeIndex);
+		}
+		WorkQueue.Push({ *RootNodeIndex, INDEX_NONE });
+		RunWorkQueue();
+	}
+}
+
+void UGameFlowAsset::CompileProgram()
+{
+	LLM_SCOPE_BYTAG(GameFlow_Assets);
+	Program.Compile(this);
+}
+
+void UGameFlowAsset::TriggerOutputPin(int32 OutputPinIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GameFlow_TriggerPin);
+	INC_DWORD_STAT(STAT_GameFlow_PinsTriggered);
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	const FGameFlowProgramPin& OutputPin = CurrentProgram.OutputPins[OutputPinIndex];
+#if WITH_EDITOR
+	if(OutputPin.Handle != nullptr)
+	{
+		OutputPin.Handle->NotifyTriggered();
+	}
+#endif
+	AdvancePrefetching(OutputPin);
+	
+	// Queue all the input pins connected to the triggered output pin.
+	const int32 LastEdge = OutputPin.FirstEdge + OutputPin.NumEdges;
+	for(int32 EdgeIndex = OutputPin.FirstEdge; EdgeIndex < LastEdge; ++EdgeIndex)
+	{
+		const int32 InputPinIndex = CurrentProgram.Edges[EdgeIndex];
+		WorkQueue.Push({ CurrentProgram.InputPins[InputPinIndex].NodeIndex, InputPinIndex });
+	}
+	
+	// When triggered from outside a node execution (e.g. timers or world events),
+	// start draining the queue right away.
+	if(!bIsRunningWorkQueue)
+	{
+		RunWorkQueue();
+	}
+}
+
+void UGameFlowAsset::DeferOutputPin(int32 OutputPinIndex)
+{
+	UWorld* World = GetWorld();
+	// Outside of a world there is no next frame, trigger the pin right away.
+	if(World == nullptr)
+	{
+		TriggerOutputPin(OutputPinIndex);
+		return;
+	}
+
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	const FGameFlowProgramPin& OutputPin = CurrentProgram.OutputPins[OutputPinIndex];
+#if WITH_EDITOR
+	if(OutputPin.Handle != nullptr)
+	{
+		OutputPin.Handle->NotifyTriggered();
+	}
+#endif
+	AdvancePrefetching(OutputPin);
+	INC_DWORD_STAT(STAT_GameFlow_PinsTriggered);
+
+	const int32 LastEdge = OutputPin.FirstEdge + OutputPin.NumEdges;
+	for(int32 EdgeIndex = OutputPin.FirstEdge; EdgeIndex < LastEdge; ++EdgeIndex)
+	{
+		const int32 InputPinIndex = CurrentProgram.Edges[EdgeIndex];
+		DeferredActivations.Add({ CurrentProgram.InputPins[InputPinIndex].NodeIndex, InputPinIndex });
+	}
+
+	if(!DeferredActivationsTimerHandle.IsValid())
+	{
+		DeferredActivationsTimerHandle = World->GetTimerManager().SetTimerForNextTick(
+			FTimerDelegate::CreateUObject(this, &UGameFlowAsset::FlushDeferredActivations));
+	}
+}
+
+void UGameFlowAsset::AdvancePrefetching(const FGameFlowProgramPin& OutputPin)
+{
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	if(!CurrentProgram.HasPrefetchPaths()) return;
+	
+	// Latent nodes trigger their outputs many times, they are only deactivated once finished.
+	const int32 LastEdge = OutputPin.FirstEdge + OutputPin.NumEdges;
+	for(int32 EdgeIndex = OutputPin.FirstEdge; EdgeIndex < LastEdge; ++EdgeIndex)
 	{
-		RootNode->TryExecute("Exec");
+		Prefetcher.Activate(CurrentProgram, CurrentProgram.InputPins[CurrentProgram.Edges[EdgeIndex]].NodeIndex);
 	}
 }
 
+void UGameFlowAsset::FinishNode(int32 NodeIndex)
+{
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	if(CurrentProgram.HasPrefetchPaths())
+	{
+		Prefetcher.Deactivate(CurrentProgram, NodeIndex);
+	}
+}
+
+void UGameFlowAsset::RunWorkQueue()
+{
+	// Nested calls will be served by the outermost loop.
+	if(bIsRunningWorkQueue) return;
+
+	UGameFlowSubsystem* Subsystem = GetTypedOuter<UGameFlowSubsystem>();
+	if(Subsystem != nullptr)
+	{
+		Subsystem->GetScheduler().Run(this);
+		// Instances which finished while executing can be recycled now.
+		Subsystem->FlushPendingReleases();
+	}
+	else
+	{
+		int32 NumExecuted = 0;
+		DrainWorkQueue(0.0, NumExecuted);
+	}
+}
+
+bool UGameFlowAsset::DrainWorkQueue(double Deadline, int32& OutNumExecuted)
+{
+	if(bIsRunningWorkQueue) return false;
+	
+	TGuardValue<bool> RunningGuard(bIsRunningWorkQueue, true);
+	// Let shared nodes know which instance they are running for.
+	FGameFlowInstanceScope InstanceScope(this);
+	WorkQueue.SetOrder(ExecutionOrder);
+	WorkQueue.CommitBatch();
+	
+	FGameFlowActivation Activation;
+	while(WorkQueue.Pop(Activation))
+	{
+		ExecuteActivation(Activation);
+		// Schedule all the activations triggered by the executed node.
+		WorkQueue.CommitBatch();
+		++OutNumExecuted;
+
+		// Out of budget, remaining activations will be resumed during the next frame.
+		if(Deadline > 0.0 && FPlatformTime::Seconds() >= Deadline) break;
+	}
+	return WorkQueue.IsEmpty();
+}
+
+void UGameFlowAsset::FlushDeferredActivations()
+{
+	DeferredActivationsTimerHandle.Invalidate();
+	
+	for(const FGameFlowActivation& Activation : DeferredActivations)
+	{
+		WorkQueue.Push(Activation);
+	}
+	DeferredActivations.Reset();
+	RunWorkQueue();
+}
+
+void UGameFlowAsset::ExecuteActivation(const FGameFlowActivation& Activation)
+{
+	// The shared program has been recompiled while this instance was running, e.g. when saving the source asset
+	// during a play in editor session. Pending activations and node states refer to the old layout, drop them.
+	if(InstanceState.IsStale())
+	{
+		UE_LOG(LogGameSession, Warning, TEXT("%s program has changed while running, its instance state has been reset."), *GetName());
+		WorkQueue.Reset();
+		InstanceState.Reset();
+		return;
+	}
+	
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	const FGameFlowProgramNode& ProgramNode = CurrentProgram.Nodes[Activation.NodeIndex];
+	FName PinName = "Exec";
+	int32 PinIndex = INDEX_NONE;
+	if(Activation.InputPinIndex != INDEX_NONE)
+	{
+		const FGameFlowProgramPin& InputPin = CurrentProgram.InputPins[Activation.InputPinIndex];
+		PinName = InputPin.PinName;
+		PinIndex = Activation.InputPinIndex - ProgramNode.FirstInput;
+#if WITH_EDITOR
+		if(InputPin.Handle != nullptr)
+		{
+			InputPin.Handle->NotifyTriggered();
+		}
+#endif
+	}
+
+	// Let the nodes execution is getting close to start loading their content.
+	const int32 LastPreload = ProgramNode.FirstPreload + ProgramNode.NumPreload;
+	for(int32 PreloadIndex = ProgramNode.FirstPreload; PreloadIndex < LastPreload; ++PreloadIndex)
+	{
+		CurrentProgram.Nodes[CurrentProgram.PreloadTargets[PreloadIndex]].Node->Preload();
+	}
+	
+	// Nodes triggering themselves have been deactivated when their previous execution returned.
+	if(CurrentProgram.HasPrefetchPaths())
+	{
+		Prefetcher.Activate(CurrentProgram, Activation.NodeIndex);
+	}
+	
+	bIsSnapshotDirty = true;
+	if(!FGameFlowProfiler::IsEnabled())
+	{
+		ProgramNode.Node->TryExecute(PinName, PinIndex);
+	}
+	else
+	{
+		// Subgraphs run their child instance inline, the profiler excludes the nested executions.
+		FGameFlowProfiler::BeginExecution();
+		ProgramNode.Node->TryExecute(PinName, PinIndex);
+		// Duplicated instances are named after their source asset, drop the number suffix to group them together.
+		const FName AssetName = SourceAsset != nullptr? SourceAsset->GetFName() : (IsAsset()? GetFName() : FName(GetFName(), 0));
+		FGameFlowProfiler::EndExecution(AssetName, ProgramNode.Node->GetClass());
+	}
+
+	// Nodes which are done once their execution returns have already activated the nodes they triggered.
+	if(!ProgramNode.Node->IsLatent())
+	{
+		FinishNode(Activation.NodeIndex);
+	}
+}
+
+void UGameFlowAsset::InitializeInstanceState()
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	InstanceState.Initialize(GetProgram());
+	bIsSnapshotDirty = true;
+	PreloadInitialNodes();
+}
+
+void UGameFlowAsset::PreloadInitialNodes()
+{
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	if(CurrentProgram.InitialPreloads.Num() == 0) return;
+	
+	FGameFlowInstanceScope InstanceScope(this);
+	for(const int32 NodeIndex : CurrentProgram.InitialPreloads)
+	{
+		CurrentProgram.Nodes[NodeIndex].Node->Preload();
+	}
+}
+
+void UGameFlowAsset::ResetInstance()
+{
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	if(InstanceState.IsInitialized())
+	{
+		// Let nodes release what they have bound to this instance, e.g. timers.
+		FGameFlowInstanceScope InstanceScope(this);
+		for(int32 NodeIndex = 0; NodeIndex < CurrentProgram.Nodes.Num(); ++NodeIndex)
+		{
+			void* NodeState = InstanceState.GetNodeState(NodeIndex);
+			if(NodeState != nullptr)
+			{
+				CurrentProgram.Nodes[NodeIndex].Node->ReleaseInstanceState(NodeState);
+			}
+		}
+		InstanceState.Reset();
+		PreloadInitialNodes();
+	}
+	
+	bIsSnapshotDirty = true;
+	OnExitPoint.Clear();
+	Prefetcher.Reset();
+	WorkQueue.Reset();
+	// Recycled instances should not be resumed by the scheduler on behalf of their previous run.
+	UGameFlowSubsystem* Subsystem = GetTypedOuter<UGameFlowSubsystem>();
+	if(Subsystem != nullptr)
+	{
+		Subsystem->GetScheduler().Unschedule(this);
+	}
+	bIsScheduled = false;
+	DeferredActivations.Reset();
+	UWorld* World = GetWorld();
+	if(World != nullptr)
+	{
+		World->GetTimerManager().ClearTimer(DeferredActivationsTimerHandle);
+	}
+	DeferredActivationsTimerHandle.Invalidate();
+	
+#if WITH_EDITOR
+	ActiveNodes.Reset();
+#endif
+}
+
+bool UGameFlowAsset::SaveSnapshot(TArray<uint8>& OutData)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	if(!InstanceState.IsInitialized()) return false;
+
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	FMemoryWriter Writer(OutData);
+	FGameFlowSnapshotHeader Header;
+	Header.LayoutHash = CurrentProgram.GetLayoutHash();
+	Writer << Header;
+
+	TArray<FGameFlowActivation> PendingActivations;
+	WorkQueue.GetPendingActivations(PendingActivations);
+	SerializeActivations(Writer, PendingActivations);
+	SerializeActivations(Writer, DeferredActivations);
+
+	TArray<int32> PrefetchingNodes;
+	Prefetcher.GetActiveNodes(PrefetchingNodes);
+	Writer << PrefetchingNodes;
+
+	int32 NumStates = 0;
+	for(const FGameFlowProgramNode& ProgramNode : CurrentProgram.Nodes)
+	{
+		NumStates += ProgramNode.StateOffset != INDEX_NONE? 1 : 0;
+	}
+	Writer << NumStates;
+
+	// Each node state is prefixed with its size, so that reading never depends on what nodes read back.
+	FGameFlowInstanceScope InstanceScope(this);
+	for(int32 NodeIndex = 0; NodeIndex < CurrentProgram.Nodes.Num(); ++NodeIndex)
+	{
+		void* NodeState = InstanceState.GetNodeState(NodeIndex);
+		if(NodeState == nullptr) continue;
+
+		Writer << NodeIndex;
+		const int64 SizeOffset = Writer.Tell();
+		int32 StateSize = 0;
+		Writer << StateSize;
+		
+		const int64 StateOffset = Writer.Tell();
+		CurrentProgram.Nodes[NodeIndex].Node->SerializeInstanceState(Writer, NodeState);
+		const int64 StateEnd = Writer.Tell();
+		StateSize = static_cast<int32>(StateEnd - StateOffset);
+		Writer.Seek(SizeOffset);
+		Writer << StateSize;
+		Writer.Seek(StateEnd);
+	}
+	return !Writer.IsError();
+}
+
+bool UGameFlowAsset::RestoreSnapshot(const TArray<uint8>& Data)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	if(!IsSharedInstance() && !Program.IsCompiled())
+	{
+		CompileProgram();
+	}
+	
+	const FGameFlowProgram& CurrentProgram = GetProgram();
+	FMemoryReader Reader(Data);
+	FGameFlowSnapshotHeader Header;
+	Reader << Header;
+	if(Reader.IsError() || !Header.IsValid() || Header.LayoutHash != CurrentProgram.GetLayoutHash())
+	{
+		UE_LOG(LogGameSession, Warning, TEXT("%s: snapshot does not match the asset and has been discarded"), *GetName());
+		return false;
+	}
+
+	TArray<FGameFlowActivation> PendingActivations;
+	TArray<FGameFlowActivation> SavedDeferredActivations;
+	TArray<int32> PrefetchingNodes;
+	SerializeActivations(Reader, PendingActivations);
+	SerializeActivations(Reader, SavedDeferredActivations);
+	Reader << PrefetchingNodes;
+
+	auto IsInvalid = [&CurrentProgram](const FGameFlowActivation& Activation) { return !IsValidActivation(CurrentProgram, Activation); };
+	if(Reader.IsError() || PendingActivations.ContainsByPredicate(IsInvalid) || SavedDeferredActivations.ContainsByPredicate(IsInvalid)
+		|| !AreValidNodeStates(Reader, CurrentProgram))
+	{
+		UE_LOG(LogGameSession, Warning, TEXT("%s: snapshot is corrupted and has been discarded"), *GetName());
+		return false;
+	}
+
+	// The payload has been accepted, start from a clean instance, then read the nodes state back.
+	if(InstanceState.IsInitialized())
+	{
+		ResetInstance();
+	}
+	else
+	{
+		InitializeInstanceState();
+	}
+
+	{
+		FGameFlowInstanceScope InstanceScope(this);
+		int32 NumStates = 0;
+		Reader << NumStates;
+		for(int32 Index = 0; Index < NumStates && !Reader.IsError(); ++Index)
+		{
+			int32 NodeIndex = INDEX_NONE;
+			int32 StateSize = 0;
+			Reader << NodeIndex << StateSize;
+			const int64 StateEnd = Reader.Tell() + StateSize;
+			if(StateSize < 0 || StateEnd > Reader.TotalSize())
+			{
+				Reader.SetError();
+				break;
+			}
+			
+			void* NodeState = InstanceState.GetNodeState(NodeIndex);
+			if(NodeState != nullptr)
+			{
+				CurrentProgram.Nodes[NodeIndex].Node->SerializeInstanceState(Reader, NodeState);
+			}
+			Reader.Seek(StateEnd);
+		}
+	}
+	if(Reader.IsError())
+	{
+		// A node failed reading its state back, do not leave the instance half restored.
+		UE_LOG(LogGameSession, Warning, TEXT("%s: snapshot is corrupted and has been discarded"), *GetName());
+		ResetInstance();
+		return false;
+	}
+
+	if(CurrentProgram.HasPrefetchPaths())
+	{
+		for(const int32 NodeIndex : PrefetchingNodes)
+		{
+			Prefetcher.Activate(CurrentProgram, NodeIndex);
+		}
+	}
+
+	// Resume the pending work.
+	UWorld* World = GetWorld();
+	if(World != nullptr && SavedDeferredActivations.Num() > 0)
+	{
+		DeferredActivations = MoveTemp(SavedDeferredActivations);
+		DeferredActivationsTimerHandle = World->GetTimerManager().SetTimerForNextTick(
+			FTimerDelegate::CreateUObject(this, &UGameFlowAsset::FlushDeferredActivations));
+	}
+	else
+	{
+		PendingActivations.Append(SavedDeferredActivations);
+	}
+	
+	for(const FGameFlowActivation& Activation : PendingActivations)
+	{
+		WorkQueue.Push(Activation);
+	}
+	if(!WorkQueue.IsEmpty())
+	{
+		RunWorkQueue();
+	}
+	return true;
+}
+
 void UGameFlowAsset::TerminateExecution()
 {
 #if WITH_EDITOR
@@ -38,25 +559,140 @@ void UGameFlowAsset::TerminateExecution()
 
 UGameFlowAsset* UGameFlowAsset::CreateInstance(UObject* Context)
 {
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
 	UGameFlowAsset* Instance = nullptr;
 	if(Context != nullptr && IsAsset())
 	{
-		Instance = DuplicateObject(this, Context);
+		// Make sure the program is available before duplicating, so that
+		// instances can share it without compiling it again.
+		if(!Program.IsCompiled())
+		{
+			CompileProgram();
+		}
+		
+		bool bShareNodes = bShareGraphBetweenInstances && Program.CanShareNodes();
 #if WITH_EDITOR
-		Instance->TemplateAsset = this;
+		// Unsaved graphs may differ from the compiled program, let the instance compile its own copy.
+		bShareNodes &= !GetPackage()->IsDirty();
 #endif
+		
+		if(bShareNodes)
+		{
+			// Shared instances only own the nodes runtime state, nodes are read from this asset.
+			const FName InstanceName = MakeUniqueObjectName(Context, GetClass(), GetFName());
+			Instance = NewObject<UGameFlowAsset>(Context, GetClass(), InstanceName);
+			Instance->SourceAsset = this;
+			Instance->bShouldBeSingleton = bShouldBeSingleton;
+			Instance->ExecutionOrder = ExecutionOrder;
+			Instance->Priority = Priority;
+			Instance->CustomInputs = CustomInputs;
+			Instance->CustomOutputs = CustomOutputs;
+#if WITH_EDITOR
+			Instance->TemplateAsset = this;
+#endif
+		}
+		else
+		{
+			Instance = DuplicateObject(this, Context);
+			Instance->Program.CopyLoadingTables(Program);
+#if WITH_EDITOR
+			Instance->TemplateAsset = this;
+			// Inside the editor the graph may have changed since the last save, recompile it.
+			Instance->CompileProgram();
+#endif
+		}
+		Instance->InitializeInstanceState();
 	}
 	
 	return Instance;
 }
 
+void UGameFlowAsset::PostLoad()
+{
+	LLM_SCOPE_BYTAG(GameFlow_Assets);
+	Super::PostLoad();
+
+	// State layout depends on the runtime size of node state structs, and it is not serialized.
+	Program.UpdateRuntimeTables();
+}
+
+void UGameFlowAsset::PostDuplicate(bool bDuplicateForPIE)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Assets);
+	Super::PostDuplicate(bDuplicateForPIE);
+	Program.UpdateStateLayout();
+	// Instances copy the loading tables of their source asset in CreateInstance, do not walk the graph for each of them.
+	if(IsAsset())
+	{
+		Program.UpdatePreloadTable();
+		Program.UpdatePrefetchTable();
+	}
+}
+
+void UGameFlowAsset::BeginDestroy()
+{
+	InstanceState.Release();
+	Prefetcher.Reset();
+	Super::BeginDestroy();
+}
+
+void UGameFlowAsset::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// Runtime state is never serialized, estimated totals would miss it.
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(InstanceState.GetAllocatedSize() + WorkQueue.GetAllocatedSize()
+		+ DeferredActivations.GetAllocatedSize() + Prefetcher.GetAllocatedSize());
+	if(CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::Exclusive)
+	{
+		CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetClass()->GetStructureSize() + Program.GetAllocatedSize());
+	}
+}
+
+bool UGameFlowAsset::CanBeClusterRoot() const
+{
+	// Instances duplicating the nodes may store any object inside them, which clusters cannot track.
+	return IsAsset() && SourceAsset == nullptr && bShareGraphBetweenInstances && Program.CanShareNodes();
+}
+
 #if WITH_EDITOR
 
+void UGameFlowAsset::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+	
+	// Keep the compiled program in sync with the graph, cooked builds will only use this representation.
+	CompileProgram();
+	if(SaveContext.IsCooking() && UGameFlowRuntimeSettings::Get()->bInlineSubgraphsOnCook)
+	{
+		Program.InlineSubgraphs(this, CookInlinedNodes);
+	}
+}
+
+void UGameFlowAsset::PostSave(FObjectPostSaveContext SaveContext)
+{
+	Super::PostSave(SaveContext);
+
+	// The flattened program only belongs to the cooked package, give the editor asset its own graph back.
+	if(CookInlinedNodes.Num() > 0 || Program.NodeSources.Num() > 0)
+	{
+		for(UGameFlowNode* Node : CookInlinedNodes)
+		{
+			if(Node == nullptr) continue;
+			
+			Node->Rename(nullptr, GetTransientPackage(), REN_DontCreateRedirectors | REN_NonTransactional | REN_DoNotDirty);
+			Node->MarkAsGarbage();
+		}
+		CookInlinedNodes.Reset();
+		CompileProgram();
+	}
+}
+
 void UGameFlowAsset::AddActiveNode(UGameFlowNode* Node)
 {
 	if(Node != nullptr)
 	{
-		ActiveNodes.Add(Node);
+		ActiveNodes.AddUnique(Node);
 	}
 }
 
@@ -86,15 +722,22 @@ void UGameFlowAsset::RemoveNode(UGameFlowNode* Node)
 	}
 }
 
-TArray<UGameFlowNode*> UGameFlowAsset::GetNodes() const
+const TMap<FGuid, UGameFlowNode*>& UGameFlowAsset::GetNodes() const
 {
-	TArray<UGameFlowNode*> NodeAssets;
-	Nodes.GenerateValueArray(NodeAssets);
-	return NodeAssets;
+	// Shared instances do not own any node.
+	if(SourceAsset != nullptr)
+	{
+		return SourceAsset->GetNodes();
+	}
+	return Nodes;
 }
 
 UGameFlowNode* UGameFlowAsset::GetNodeByGUID(FGuid GUID) const
 {
+	if(SourceAsset != nullptr)
+	{
+		return SourceAsset->GetNodeByGUID(GUID);
+	}
 	return GUID.IsValid()? Nodes.FindRef(GUID) : nullptr;
 }
 
@@ -0,0 +1,60 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowEventBus.h"
+#include "GameFlowListener.h"
+
+FGameFlowEventBus::FGameFlowEventBus(int32 InCapacity)
+{
+	Buffer.SetNum(FMath::Max(InCapacity, 1));
+}
+
+bool FGameFlowEventBus::Enqueue(FGameFlowBusEvent&& Event)
+{
+	const uint32 Hash = HashEvent(Event);
+	const uint64* PendingSequence = PendingEvents.Find(Hash);
+	if (PendingSequence != nullptr && *PendingSequence >= HeadSequence)
+	{
+		FGameFlowBusEvent& PendingEvent = Buffer[*PendingSequence % Buffer.Num()];
+		if (PendingEvent.IsSameNotification(Event))
+		{
+			PendingEvent.Occurrences += Event.Occurrences;
+			return true;
+		}
+	}
+
+	if (NumEvents == Buffer.Num()) return false;
+
+	const uint64 Sequence = HeadSequence + NumEvents++;
+	Buffer[Sequence % Buffer.Num()] = MoveTemp(Event);
+	// Hash collisions simply skip coalescing for the newest notification.
+	if (PendingSequence == nullptr || *PendingSequence < HeadSequence)
+	{
+		PendingEvents.Add(Hash, Sequence);
+	}
+	return true;
+}
+
+void FGameFlowEventBus::Flush(TFunctionRef<void(const FGameFlowBusEvent&)> Dispatch)
+{
+	// Notifications sent by the dispatched ones must not be merged into already dispatched events.
+	PendingEvents.Reset();
+	
+	int32 NumToDispatch = NumEvents;
+	while (NumToDispatch-- > 0)
+	{
+		const FGameFlowBusEvent Event = MoveTemp(Buffer[HeadSequence % Buffer.Num()]);
+		++HeadSequence;
+		--NumEvents;
+		Dispatch(Event);
+	}
+}
+
+uint32 FGameFlowEventBus::HashEvent(const FGameFlowBusEvent& Event)
+{
+	uint32 TagsHash = 0;
+	for (const FGameplayTag& Tag : Event.Tags)
+	{
+		TagsHash ^= GetTypeHash(Tag);
+	}
+	return HashCombine(HashCombine(GetTypeHash(Event.Sender), static_cast<uint32>(Event.MatchType)), TagsHash);
+}
@@ -3,6 +3,7 @@
 #include "GameFlowListener.h"
 #include "GameFlowSubsystem.h"
 #include "Engine/GameInstance.h"
+#include "Engine/Level.h"
 #include "Engine/World.h"
 
 // Sets default values for this component's properties
@@ -14,10 +15,42 @@ UGameFlowListener::UGameFlowListener()
 	// ...
 }
 
+void UGameFlowListener::OnRegister()
+{
+	Super::OnRegister();
+	UpdateTagMasks();
+
+	UGameFlowSubsystem* GameFlowSubsystem = GetGameFlowSubsystem();
+	if(GameFlowSubsystem != nullptr)
+	{
+		GameFlowSubsystem->RegisterListener(this);
+	}
+}
+
+void UGameFlowListener::OnUnregister()
+{
+	// Listeners of levels being streamed out are unregistered all at once by the subsystem.
+	const ULevel* Level = GetComponentLevel();
+	UGameFlowSubsystem* GameFlowSubsystem = GetGameFlowSubsystem();
+	if(GameFlowSubsystem != nullptr && (Level == nullptr || !Level->bIsBeingRemoved))
+	{
+		GameFlowSubsystem->UnregisterListener(this);
+	}
+	
+	Super::OnUnregister();
+}
+
 // Called when the game starts
 void UGameFlowListener::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// The game instance may not have been available yet when the component has been registered.
+	UGameFlowSubsystem* GameFlowSubsystem = GetGameFlowSubsystem();
+	if(GameFlowSubsystem != nullptr && !GameFlowSubsystem->IsListenerRegistered(this))
+	{
+		GameFlowSubsystem->RegisterListener(this);
+	}
 }
 
 void UGameFlowListener::DestroyComponent(bool bPromoteChildren)
@@ -34,14 +67,31 @@ void UGameFlowListener::TickComponent(float DeltaTime, ELevelTick TickType,
 	// ...
 }
 
+void UGameFlowListener::NotifyGameFlow(FGameplayTagContainer GameplayTags)
+{
+	UGameFlowSubsystem* GameFlowSubsystem = GetGameFlowSubsystem();
+	if(GameFlowSubsystem != nullptr)
+	{
+		GameFlowSubsystem->NotifyFromListener(this, GameplayTags);
+	}
+	else
+	{
+		OnNotifyGameFlowListener.Broadcast(GameplayTags);
+	}
+}
+
 void UGameFlowListener::AddGameplayTag(FGameplayTag GameplayTag)
 {
 	if(GameplayTag.IsValid())
 	{
-		const UGameFlowSubsystem* GameFlowSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
+		UGameFlowSubsystem* GameFlowSubsystem = GetGameFlowSubsystem();
 		
 		IdentityTags.AddTag(GameplayTag);
-		GameFlowSubsystem->OnGameplayTagAdded.Broadcast(this, GameplayTag);
+		UpdateTagMasks();
+		if(GameFlowSubsystem != nullptr)
+		{
+			GameFlowSubsystem->AddListenerTag(this, GameplayTag);
+		}
 	}
 }
 
@@ -49,9 +99,38 @@ void UGameFlowListener::RemoveGameplayTag(FGameplayTag GameplayTag)
 {
 	if(GameplayTag.IsValid())
 	{
-		const UGameFlowSubsystem* GameFlowSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
+		UGameFlowSubsystem* GameFlowSubsystem = GetGameFlowSubsystem();
 		
 		IdentityTags.RemoveTag(GameplayTag);
-		GameFlowSubsystem->OnGameplayTagRemoved.Broadcast(this, GameplayTag);
+		UpdateTagMasks();
+		if(GameFlowSubsystem != nullptr)
+		{
+			GameFlowSubsystem->RemoveListenerTag(this, GameplayTag);
+		}
+	}
+}
+
+UGameFlowSubsystem* UGameFlowListener::GetGameFlowSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	if(World == nullptr || !World->IsGameWorld()) return nullptr;
+
+	const UGameInstance* GameInstance = World->GetGameInstance();
+	return GameInstance != nullptr? GameInstance->GetSubsystem<UGameFlowSubsystem>() : nullptr;
+}
+
+bool UGameFlowListener::MatchesTags(const FGameplayTagContainer& Tags, const FGameFlowTagMask& TagsMask,
+	EGameplayContainerMatchType MatchType) const
+{
+	if(IdentityMask.IsValid() && TagsMask.IsValid())
+	{
+		return IdentityMask.Matches(TagsMask, MatchType);
 	}
+	return MatchType == EGameplayContainerMatchType::All? IdentityTags.HasAll(Tags) : IdentityTags.HasAny(Tags);
+}
+
+void UGameFlowListener::UpdateTagMasks()
+{
+	IdentityMask = FGameFlowTagMask::Make(IdentityTags, true);
+	ExactIdentityMask = FGameFlowTagMask::Make(IdentityTags, false);
 }
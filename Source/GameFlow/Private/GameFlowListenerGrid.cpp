@@ -0,0 +1,122 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowListenerGrid.h"
+#include "GameFlowListener.h"
+
+FGameFlowListenerGrid::FGameFlowListenerGrid(float InCellSize)
+	: CellSize(FMath::Max(InCellSize, 1.f))
+{
+}
+
+void FGameFlowListenerGrid::Update(UGameFlowListener* Listener, const FVector& Location)
+{
+	if (Listener == nullptr) return;
+	
+	const FIntVector Cell = GetCell(Location);
+	FEntry* Entry = Entries.Find(Listener);
+	if (Entry != nullptr)
+	{
+		Entry->Location = Location;
+		// Only crossing a cell boundary touches the grid.
+		if (Entry->Cell == Cell) return;
+
+		TArray<UGameFlowListener*>& PreviousCell = Cells.FindChecked(Entry->Cell);
+		PreviousCell.RemoveSwap(Listener);
+		if (PreviousCell.IsEmpty())
+		{
+			Cells.Remove(Entry->Cell);
+		}
+		Entry->Cell = Cell;
+	}
+	else
+	{
+		Entries.Add(Listener, { Location, Cell });
+	}
+	Cells.FindOrAdd(Cell).Add(Listener);
+}
+
+void FGameFlowListenerGrid::Remove(UGameFlowListener* Listener)
+{
+	FEntry Entry;
+	if (!Entries.RemoveAndCopyValue(Listener, Entry)) return;
+
+	TArray<UGameFlowListener*>& Cell = Cells.FindChecked(Entry.Cell);
+	Cell.RemoveSwap(Listener);
+	if (Cell.IsEmpty())
+	{
+		Cells.Remove(Entry.Cell);
+	}
+}
+
+void FGameFlowListenerGrid::QueryBox(const FBox& Box, TArray<UGameFlowListener*>& OutListeners) const
+{
+	ForEachCandidate(Box, [&Box, &OutListeners](UGameFlowListener* Listener, const FVector& Location)
+	{
+		if (Box.IsInsideOrOn(Location))
+		{
+			OutListeners.Add(Listener);
+		}
+	});
+}
+
+void FGameFlowListenerGrid::QuerySphere(const FVector& Center, float Radius, TArray<UGameFlowListener*>& OutListeners) const
+{
+	const double RadiusSquared = FMath::Square(Radius);
+	ForEachCandidate(FBox::BuildAABB(Center, FVector(Radius)), [&](UGameFlowListener* Listener, const FVector& Location)
+	{
+		if (FVector::DistSquared(Center, Location) <= RadiusSquared)
+		{
+			OutListeners.Add(Listener);
+		}
+	});
+}
+
+void FGameFlowListenerGrid::Reset()
+{
+	Cells.Reset();
+	Entries.Reset();
+}
+
+FIntVector FGameFlowListenerGrid::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+void FGameFlowListenerGrid::ForEachCandidate(const FBox& Box, TFunctionRef<void(UGameFlowListener*, const FVector&)> Visitor) const
+{
+	if (!Box.IsValid) return;
+	
+	const FIntVector MinCell = GetCell(Box.Min);
+	const FIntVector MaxCell = GetCell(Box.Max);
+	const int64 NumCells = int64(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+
+	// Huge areas overlap more cells than there are listeners, scanning them is cheaper.
+	if (NumCells > Cells.Num())
+	{
+		for (const auto& [Listener, Entry] : Entries)
+		{
+			Visitor(Listener, Entry.Location);
+		}
+		return;
+	}
+	
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<UGameFlowListener*>* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (Cell == nullptr) continue;
+
+				for (UGameFlowListener* Listener : *Cell)
+				{
+					Visitor(Listener, Entries.FindChecked(Listener).Location);
+				}
+			}
+		}
+	}
+}
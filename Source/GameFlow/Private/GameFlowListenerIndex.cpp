@@ -0,0 +1,144 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowListenerIndex.h"
+#include "GameFlowListener.h"
+
+void FGameFlowListenerIndex::AddListener(UGameFlowListener* Listener)
+{
+	if (Listener == nullptr || ListenerTags.Contains(Listener)) return;
+
+	FGameplayTagContainer& IndexedTags = ListenerTags.Add(Listener, Listener->IdentityTags);
+	for (const FGameplayTag& Tag : IndexedTags)
+	{
+		UpdateBuckets(Listener, Tag, 1);
+	}
+}
+
+void FGameFlowListenerIndex::RemoveListener(UGameFlowListener* Listener)
+{
+	FGameplayTagContainer IndexedTags;
+	if (!ListenerTags.RemoveAndCopyValue(Listener, IndexedTags)) return;
+
+	for (const FGameplayTag& Tag : IndexedTags)
+	{
+		UpdateBuckets(Listener, Tag, -1);
+	}
+}
+
+void FGameFlowListenerIndex::AddTag(UGameFlowListener* Listener, FGameplayTag Tag)
+{
+	FGameplayTagContainer* IndexedTags = ListenerTags.Find(Listener);
+	if (IndexedTags == nullptr || !Tag.IsValid() || IndexedTags->HasTagExact(Tag)) return;
+
+	IndexedTags->AddTag(Tag);
+	UpdateBuckets(Listener, Tag, 1);
+}
+
+void FGameFlowListenerIndex::RemoveTag(UGameFlowListener* Listener, FGameplayTag Tag)
+{
+	FGameplayTagContainer* IndexedTags = ListenerTags.Find(Listener);
+	if (IndexedTags == nullptr || !IndexedTags->RemoveTag(Tag)) return;
+
+	UpdateBuckets(Listener, Tag, -1);
+}
+
+void FGameFlowListenerIndex::Query(const FGameplayTagContainer& Tags, EGameplayContainerMatchType MatchType,
+	TArray<UGameFlowListener*>& OutListeners) const
+{
+	if (MatchType == EGameplayContainerMatchType::Any)
+	{
+		// Union of the queried tags buckets. Listeners of the previous buckets have already been collected.
+		TArray<const TMap<UGameFlowListener*, int32>*, TInlineAllocator<8>> VisitedBuckets;
+		for (const FGameplayTag& Tag : Tags)
+		{
+			const TMap<UGameFlowListener*, int32>* Bucket = Buckets.Find(Tag);
+			if (Bucket == nullptr) continue;
+
+			for (const auto& [Listener, Count] : *Bucket)
+			{
+				const bool bIsAlreadyMatching = VisitedBuckets.ContainsByPredicate([Listener](const TMap<UGameFlowListener*, int32>* VisitedBucket)
+				{
+					return VisitedBucket->Contains(Listener);
+				});
+				if (!bIsAlreadyMatching)
+				{
+					OutListeners.Add(Listener);
+				}
+			}
+			VisitedBuckets.Add(Bucket);
+		}
+		return;
+	}
+
+	// Empty queries are matched by every listener, as FGameplayTagContainer::HasAll does.
+	if (Tags.IsEmpty())
+	{
+		OutListeners.Reserve(OutListeners.Num() + ListenerTags.Num());
+		for (const auto& [Listener, IndexedTags] : ListenerTags)
+		{
+			OutListeners.Add(Listener);
+		}
+		return;
+	}
+
+	// Intersection of the queried tags buckets, walking the smallest one.
+	TArray<const TMap<UGameFlowListener*, int32>*, TInlineAllocator<8>> QueriedBuckets;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		const TMap<UGameFlowListener*, int32>* Bucket = Buckets.Find(Tag);
+		if (Bucket == nullptr) return;
+		
+		QueriedBuckets.Add(Bucket);
+	}
+	QueriedBuckets.Sort([](const TMap<UGameFlowListener*, int32>& A, const TMap<UGameFlowListener*, int32>& B)
+	{
+		return A.Num() < B.Num();
+	});
+
+	for (const auto& [Listener, Count] : *QueriedBuckets[0])
+	{
+		bool bMatchesAll = true;
+		for (int32 BucketIndex = 1; BucketIndex < QueriedBuckets.Num() && bMatchesAll; ++BucketIndex)
+		{
+			bMatchesAll = QueriedBuckets[BucketIndex]->Contains(Listener);
+		}
+		
+		if (bMatchesAll)
+		{
+			OutListeners.Add(Listener);
+		}
+	}
+}
+
+void FGameFlowListenerIndex::Reset()
+{
+	Buckets.Reset();
+	ListenerTags.Reset();
+}
+
+void FGameFlowListenerIndex::UpdateBuckets(UGameFlowListener* Listener, FGameplayTag Tag, int32 Count)
+{
+	// A listener tag also matches queries on all its parent tags.
+	const FGameplayTagContainer MatchingTags = Tag.GetGameplayTagParents();
+	for (const FGameplayTag& MatchingTag : MatchingTags)
+	{
+		if (Count > 0)
+		{
+			Buckets.FindOrAdd(MatchingTag).FindOrAdd(Listener) += Count;
+			continue;
+		}
+
+		TMap<UGameFlowListener*, int32>* Bucket = Buckets.Find(MatchingTag);
+		if (Bucket == nullptr) continue;
+
+		int32* ListenerCount = Bucket->Find(Listener);
+		if (ListenerCount != nullptr && (*ListenerCount += Count) <= 0)
+		{
+			Bucket->Remove(Listener);
+			if (Bucket->IsEmpty())
+			{
+				Buckets.Remove(MatchingTag);
+			}
+		}
+	}
+}
@@ -0,0 +1,131 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowListenerRouter.h"
+#include "GameFlowListener.h"
+
+FGameFlowListenerSubscriptionHandle FGameFlowListenerRouter::Subscribe(const FGameplayTagContainer& Tags,
+	FOnGameFlowListenerEvent Delegate)
+{
+	int32 SubscriptionIndex = FirstFreeSubscription;
+	if (SubscriptionIndex != INDEX_NONE)
+	{
+		FirstFreeSubscription = Subscriptions[SubscriptionIndex].NextFree;
+	}
+	else
+	{
+		SubscriptionIndex = Subscriptions.AddDefaulted();
+	}
+
+	FSubscription& Subscription = Subscriptions[SubscriptionIndex];
+	Subscription.Delegate = MoveTemp(Delegate);
+	Subscription.NextFree = INDEX_NONE;
+	const FGameFlowListenerSubscriptionHandle Handle(SubscriptionIndex, Subscription.Generation);
+
+	// File the subscription under its tags and all their parents.
+	if (Tags.IsEmpty())
+	{
+		Routes.FindOrAdd(FGameplayTag::EmptyTag).Add(Handle);
+	}
+	else
+	{
+		const FGameplayTagContainer RouteTags = Tags.GetGameplayTagParents();
+		for (const FGameplayTag& Tag : RouteTags)
+		{
+			Routes.FindOrAdd(Tag).Add(Handle);
+		}
+	}
+	return Handle;
+}
+
+void FGameFlowListenerRouter::Unsubscribe(FGameFlowListenerSubscriptionHandle& Handle)
+{
+	if (Subscriptions.IsValidIndex(Handle.GetIndex()))
+	{
+		FSubscription& Subscription = Subscriptions[Handle.GetIndex()];
+		if (Subscription.Generation == Handle.GetGeneration())
+		{
+			// Routes entries are left behind and dropped lazily during the next dispatch through them.
+			Subscription.Delegate.Unbind();
+			Subscription.Generation++;
+			Subscription.NextFree = FirstFreeSubscription;
+			FirstFreeSubscription = Handle.GetIndex();
+		}
+	}
+	Handle.Invalidate();
+}
+
+void FGameFlowListenerRouter::DispatchListenerEvent(EGameFlowListenerEvent Event, UGameFlowListener* Listener)
+{
+	if (Listener == nullptr) return;
+	
+	++DispatchCounter;
+	TArray<FGameFlowListenerSubscriptionHandle, TInlineAllocator<16>> Handles;
+	CollectRoute(FGameplayTag::EmptyTag, Handles);
+	for (const FGameplayTag& Tag : Listener->IdentityTags)
+	{
+		CollectRouteHierarchy(Tag, Handles);
+	}
+	Execute(Handles, Event, Listener, FGameplayTag::EmptyTag);
+}
+
+void FGameFlowListenerRouter::DispatchTagEvent(EGameFlowListenerEvent Event, UGameFlowListener* Listener, FGameplayTag Tag)
+{
+	++DispatchCounter;
+	TArray<FGameFlowListenerSubscriptionHandle, TInlineAllocator<16>> Handles;
+	CollectRoute(FGameplayTag::EmptyTag, Handles);
+	CollectRouteHierarchy(Tag, Handles);
+	Execute(Handles, Event, Listener, Tag);
+}
+
+void FGameFlowListenerRouter::CollectRouteHierarchy(FGameplayTag Tag, TArray<FGameFlowListenerSubscriptionHandle, TInlineAllocator<16>>& OutHandles)
+{
+	// Subscribers of a parent tag care about all its children. Subscriptions reached through
+	// several tags are only collected once per dispatch.
+	for (FGameplayTag RouteTag = Tag; RouteTag.IsValid(); RouteTag = RouteTag.RequestDirectParent())
+	{
+		CollectRoute(RouteTag, OutHandles);
+	}
+}
+
+void FGameFlowListenerRouter::CollectRoute(FGameplayTag Tag, TArray<FGameFlowListenerSubscriptionHandle, TInlineAllocator<16>>& OutHandles)
+{
+	TArray<FGameFlowListenerSubscriptionHandle>* Route = Routes.Find(Tag);
+	if (Route == nullptr) return;
+
+	for (int32 RouteIndex = Route->Num() - 1; RouteIndex >= 0; --RouteIndex)
+	{
+		const FGameFlowListenerSubscriptionHandle Handle = (*Route)[RouteIndex];
+		FSubscription& Subscription = Subscriptions[Handle.GetIndex()];
+		if (Subscription.Generation != Handle.GetGeneration())
+		{
+			Route->RemoveAtSwap(RouteIndex);
+			continue;
+		}
+
+		if (Subscription.LastDispatch != DispatchCounter)
+		{
+			Subscription.LastDispatch = DispatchCounter;
+			OutHandles.Add(Handle);
+		}
+	}
+
+	if (Route->IsEmpty())
+	{
+		Routes.Remove(Tag);
+	}
+}
+
+void FGameFlowListenerRouter::Execute(TConstArrayView<FGameFlowListenerSubscriptionHandle> Handles,
+	EGameFlowListenerEvent Event, UGameFlowListener* Listener, FGameplayTag Tag)
+{
+	for (const FGameFlowListenerSubscriptionHandle& Handle : Handles)
+	{
+		// Subscribers may unsubscribe each other while handling the event, and the subscriptions array may grow.
+		const FSubscription& Subscription = Subscriptions[Handle.GetIndex()];
+		if (Subscription.Generation == Handle.GetGeneration())
+		{
+			FOnGameFlowListenerEvent Delegate = Subscription.Delegate;
+			Delegate.ExecuteIfBound(Event, Listener, Tag);
+		}
+	}
+}
@@ -0,0 +1,55 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowMemory.h"
+#include "GameFlowAsset.h"
+#include "GameFlowSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+LLM_DEFINE_TAG(GameFlow);
+LLM_DEFINE_TAG(GameFlow_Assets);
+LLM_DEFINE_TAG(GameFlow_Instances);
+LLM_DEFINE_TAG(GameFlow_Listeners);
+LLM_DEFINE_TAG(GameFlow_EditorGraphs);
+
+namespace
+{
+	void DumpMemory(FOutputDevice& Ar)
+	{
+		TMap<const UGameFlowAsset*, FGameFlowAssetMemory> Usage;
+		for(TObjectIterator<UGameFlowAsset> It; It; ++It)
+		{
+			if(It->IsAsset())
+			{
+				Usage.FindOrAdd(*It).AssetBytes = It->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+			}
+		}
+		for(TObjectIterator<UGameFlowSubsystem> It; It; ++It)
+		{
+			It->CollectMemoryUsage(Usage);
+		}
+
+		Usage.ValueSort([](const FGameFlowAssetMemory& A, const FGameFlowAssetMemory& B)
+		{
+			return A.GetTotalBytes() > B.GetTotalBytes();
+		});
+
+		FGameFlowAssetMemory Total;
+		Ar.Logf(TEXT("%-64s %12s %12s %10s"), TEXT("Asset"), TEXT("Asset KB"), TEXT("Instances KB"), TEXT("Instances"));
+		for(const auto& [Asset, Memory] : Usage)
+		{
+			Ar.Logf(TEXT("%-64s %12.1f %12.1f %10d"), *GetNameSafe(Asset),
+				Memory.AssetBytes / 1024.f, Memory.InstanceBytes / 1024.f, Memory.NumInstances);
+			Total.AssetBytes += Memory.AssetBytes;
+			Total.InstanceBytes += Memory.InstanceBytes;
+			Total.NumInstances += Memory.NumInstances;
+		}
+		Ar.Logf(TEXT("%-64s %12.1f %12.1f %10d"), TEXT("Total"),
+			Total.AssetBytes / 1024.f, Total.InstanceBytes / 1024.f, Total.NumInstances);
+	}
+
+	FAutoConsoleCommandWithOutputDevice GDumpMemoryCommand(
+		TEXT("gameflow.memory"),
+		TEXT("Print the memory used by each loaded game flow asset and by its running and pooled instances."),
+		FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&DumpMemory));
+}
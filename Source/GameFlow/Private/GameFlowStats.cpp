@@ -0,0 +1,185 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowStats.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_STAT(STAT_GameFlow_TryExecute);
+DEFINE_STAT(STAT_GameFlow_TriggerPin);
+DEFINE_STAT(STAT_GameFlow_NotifyListeners);
+DEFINE_STAT(STAT_GameFlow_RegisterAssetInstance);
+DEFINE_STAT(STAT_GameFlow_NodesExecuted);
+DEFINE_STAT(STAT_GameFlow_PinsTriggered);
+DEFINE_STAT(STAT_GameFlow_InstancesCreated);
+DEFINE_STAT(STAT_GameFlow_InstancesDestroyed);
+DEFINE_STAT(STAT_GameFlow_ActiveInstances);
+DEFINE_STAT(STAT_GameFlow_ActiveListeners);
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarProfile(
+		TEXT("gameflow.Profile"),
+		false,
+		TEXT("If true, the time spent executing nodes is attributed to game flow assets and node classes, see gameflow.top."));
+
+	TAutoConsoleVariable<int32> CVarProfileWindow(
+		TEXT("gameflow.ProfileWindow"),
+		300,
+		TEXT("The number of frames gameflow.top and gameflow.dump report about."));
+
+	struct FProfileEntry
+	{
+		double Seconds = 0.0;
+		int32 NumExecutions = 0;
+	};
+
+	/** Executions recorded during a single frame. */
+	struct FProfileFrame
+	{
+		uint64 FrameNumber = 0;
+		TMap<FName, FProfileEntry> Assets;
+		TMap<FName, FProfileEntry> NodeClasses;
+	};
+
+	/** Ring of the last recorded frames, indexed by frame number. */
+	TArray<FProfileFrame> ProfileFrames;
+
+	/** A node execution being timed. */
+	struct FProfileExecution
+	{
+		double StartTime = 0.0;
+		/** Time spent by the executions nested inside this one, e.g. subgraph nodes run inline. */
+		double NestedSeconds = 0.0;
+	};
+
+	/** The node executions being timed, innermost last. */
+	TArray<FProfileExecution, TInlineAllocator<16>> ExecutionStack;
+
+	/** Sum the recorded frames which are still inside the window. */
+	void GatherProfile(TMap<FName, FProfileEntry>& OutAssets, TMap<FName, FProfileEntry>& OutNodeClasses)
+	{
+		const uint64 WindowSize = ProfileFrames.Num();
+		for(const FProfileFrame& Frame : ProfileFrames)
+		{
+			if(Frame.FrameNumber + WindowSize <= GFrameCounter) continue;
+
+			for(const auto& [Name, Entry] : Frame.Assets)
+			{
+				FProfileEntry& Total = OutAssets.FindOrAdd(Name);
+				Total.Seconds += Entry.Seconds;
+				Total.NumExecutions += Entry.NumExecutions;
+			}
+			for(const auto& [Name, Entry] : Frame.NodeClasses)
+			{
+				FProfileEntry& Total = OutNodeClasses.FindOrAdd(Name);
+				Total.Seconds += Entry.Seconds;
+				Total.NumExecutions += Entry.NumExecutions;
+			}
+		}
+	}
+
+	void PrintEntries(const TCHAR* Title, TMap<FName, FProfileEntry>& Entries, int32 MaxEntries, FOutputDevice& Ar)
+	{
+		Entries.ValueSort([](const FProfileEntry& A, const FProfileEntry& B) { return A.Seconds > B.Seconds; });
+
+		const int32 NumFrames = FMath::Max(ProfileFrames.Num(), 1);
+		Ar.Logf(TEXT("%-64s %12s %12s %12s"), Title, TEXT("Total ms"), TEXT("ms/frame"), TEXT("Executions"));
+		int32 NumPrinted = 0;
+		for(const auto& [Name, Entry] : Entries)
+		{
+			if(MaxEntries >= 0 && NumPrinted++ >= MaxEntries) break;
+			Ar.Logf(TEXT("%-64s %12.3f %12.4f %12d"), *Name.ToString(), Entry.Seconds * 1000.0,
+				Entry.Seconds * 1000.0 / NumFrames, Entry.NumExecutions);
+		}
+	}
+
+	void PrintProfile(int32 MaxEntries, FOutputDevice& Ar)
+	{
+		if(!FGameFlowProfiler::IsEnabled())
+		{
+			Ar.Log(TEXT("Game flow profiling is disabled, enable it with gameflow.Profile 1."));
+			return;
+		}
+
+		TMap<FName, FProfileEntry> Assets;
+		TMap<FName, FProfileEntry> NodeClasses;
+		GatherProfile(Assets, NodeClasses);
+		Ar.Logf(TEXT("Game flow node executions over the last %d frames:"), ProfileFrames.Num());
+		PrintEntries(TEXT("Asset"), Assets, MaxEntries, Ar);
+		PrintEntries(TEXT("Node class"), NodeClasses, MaxEntries, Ar);
+	}
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice GTopCommand(
+		TEXT("gameflow.top"),
+		TEXT("Print the game flow assets and node classes which spent the most time executing nodes over the profiling window. Usage: gameflow.top [Count]"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			int32 MaxEntries = 10;
+			if(Args.Num() > 0)
+			{
+				LexFromString(MaxEntries, *Args[0]);
+			}
+			PrintProfile(FMath::Max(MaxEntries, 1), Ar);
+		}));
+
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice GDumpCommand(
+		TEXT("gameflow.dump"),
+		TEXT("Print the time spent executing nodes by all the game flow assets and node classes over the profiling window."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			PrintProfile(INDEX_NONE, Ar);
+		}));
+}
+
+bool FGameFlowProfiler::IsEnabled()
+{
+	return CVarProfile.GetValueOnGameThread();
+}
+
+void FGameFlowProfiler::BeginExecution()
+{
+	check(IsInGameThread());
+	ExecutionStack.Push({ FPlatformTime::Seconds(), 0.0 });
+}
+
+void FGameFlowProfiler::EndExecution(FName AssetName, const UClass* NodeClass)
+{
+	check(IsInGameThread());
+	if(!ensure(ExecutionStack.Num() > 0)) return;
+
+	// Nested executions are recorded on their own, only keep the time spent by this node.
+	const FProfileExecution Execution = ExecutionStack.Pop();
+	const double Seconds = FPlatformTime::Seconds() - Execution.StartTime;
+	if(ExecutionStack.Num() > 0)
+	{
+		ExecutionStack.Last().NestedSeconds += Seconds;
+	}
+	RecordExecution(AssetName, NodeClass, FMath::Max(Seconds - Execution.NestedSeconds, 0.0));
+}
+
+void FGameFlowProfiler::RecordExecution(FName AssetName, const UClass* NodeClass, double Seconds)
+{
+	check(IsInGameThread());
+	const int32 WindowSize = FMath::Max(CVarProfileWindow.GetValueOnGameThread(), 1);
+	if(ProfileFrames.Num() != WindowSize)
+	{
+		ProfileFrames.Reset();
+		ProfileFrames.SetNum(WindowSize);
+	}
+
+	// Reuse the slot of the frame which just left the window.
+	FProfileFrame& Frame = ProfileFrames[GFrameCounter % WindowSize];
+	if(Frame.FrameNumber != GFrameCounter)
+	{
+		Frame.FrameNumber = GFrameCounter;
+		Frame.Assets.Reset();
+		Frame.NodeClasses.Reset();
+	}
+
+	FProfileEntry& AssetEntry = Frame.Assets.FindOrAdd(AssetName);
+	AssetEntry.Seconds += Seconds;
+	AssetEntry.NumExecutions++;
+
+	FProfileEntry& ClassEntry = Frame.NodeClasses.FindOrAdd(GetFNameSafe(NodeClass));
+	ClassEntry.Seconds += Seconds;
+	ClassEntry.NumExecutions++;
+}
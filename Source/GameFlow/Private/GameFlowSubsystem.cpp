@@ -2,123 +2,755 @@
 
 #include "GameFlowSubsystem.h"
 #include "GameplayTagContainer.h"
+#include "GameFlowStats.h"
+#include "Config/GameFlowRuntimeSettings.h"
 #include "Engine/World.h"
 #include "GameFramework/GameSession.h"
-#include "Kismet/GameplayStatics.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Level.h"
 #include "Nodes/World/GameFlowNode_WorldListener.h"
 
 void UGameFlowSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
+	LLM_SCOPE_BYTAG(GameFlow);
 	Super::Initialize(Collection);
+	TimingWheel = FGameFlowTimingWheel(UGameFlowRuntimeSettings::Get()->TimerResolutionMs / 1000.0);
+	EventBus = FGameFlowEventBus(UGameFlowRuntimeSettings::Get()->EventBusCapacity);
+	ListenerGrid = FGameFlowListenerGrid(UGameFlowRuntimeSettings::Get()->ListenerGridCellSize);
+
+	// Listeners register themselves, only streamed levels need to be tracked.
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UGameFlowSubsystem::OnLevelAddedToWorld);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UGameFlowSubsystem::OnLevelRemovedFromWorld);
+}
+
+void UGameFlowSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	PendingAutosave.Reset();
+	Autosaver.Reset();
+	PendingReleases.Reset();
+	DEC_DWORD_STAT_BY(STAT_GameFlow_ActiveInstances, RunningInstances.Num());
+	DEC_DWORD_STAT_BY(STAT_GameFlow_ActiveListeners, Listeners.Num());
+	Super::Deinitialize();
+}
+
+void UGameFlowSubsystem::Tick(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(GameFlow);
+	// Deliver the notifications sent during the previous frame, then expire timers.
+	// The work they trigger is subject to the frame budget too.
+	EventBus.Flush([this](const FGameFlowBusEvent& Event)
+	{
+		DispatchNotification(Event);
+	});
+	TimingWheel.Advance(DeltaTime);
+	
+	// Resume the work carried over from the previous frames.
+	Scheduler.Tick();
+	FlushPendingReleases();
+
+	// No instance is executing past this point, capture the requested autosave.
+	if(PendingAutosave.IsSet() && !Autosaver.IsEncoding())
+	{
+		CaptureAutosave();
+	}
+}
+
+bool UGameFlowSubsystem::IsTickable() const
+{
+	return Scheduler.HasPendingWork() || TimingWheel.HasTimers() || EventBus.HasPendingEvents() || PendingAutosave.IsSet()
+		|| PendingReleases.Num() > 0;
+}
+
+ETickableTickType UGameFlowSubsystem::GetTickableTickType() const
+{
+	return IsTemplate()? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+UWorld* UGameFlowSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
+
+TStatId UGameFlowSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameFlowSubsystem, STATGROUP_Tickables);
+}
+
+FGameFlowSchedulerStats UGameFlowSubsystem::GetSchedulerStats() const
+{
+	return Scheduler.GetLastFrameStats();
+}
+
+void UGameFlowSubsystem::SetInstanceTimeDilation(FGameFlowInstanceHandle Handle, float TimeDilation)
+{
+	UGameFlowAsset* Instance = GetInstance(Handle);
+	if(Instance != nullptr)
+	{
+		TimingWheel.SetInstanceTimeDilation(Instance, TimeDilation);
+	}
+}
+
+void UGameFlowSubsystem::SetInstanceTimersPaused(FGameFlowInstanceHandle Handle, bool bPaused)
+{
+	UGameFlowAsset* Instance = GetInstance(Handle);
+	if(Instance != nullptr)
+	{
+		TimingWheel.SetInstancePaused(Instance, bPaused);
+	}
+}
+
+void UGameFlowSubsystem::SetTimersPaused(bool bPaused)
+{
+	TimingWheel.SetPaused(bPaused);
+}
+
+FGameFlowInstanceHandle UGameFlowSubsystem::RegisterAssetInstance(UGameFlowAsset* Asset)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	SCOPE_CYCLE_COUNTER(STAT_GameFlow_RegisterAssetInstance);
+	if(Asset == nullptr) return FGameFlowInstanceHandle();
 	
-	TArray<AActor*> WorldActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActor::StaticClass(), WorldActors);
-	for(const AActor* WorldActor : WorldActors)
+	// Singleton assets can only have one running instance.
+	if(Asset->bShouldBeSingleton)
 	{
-		UActorComponent* Component = WorldActor->GetComponentByClass(UGameFlowListener::StaticClass());
-		if(Component != nullptr)
+		const FGameFlowInstanceHandle* SingletonHandle = SingletonInstances.Find(Asset);
+		if(SingletonHandle != nullptr)
 		{
-			UGameFlowListener* ComponentListener = CastChecked<UGameFlowListener>(Component);
-			RegisterListener(ComponentListener);
+			// Print the warning message both on the screen and in the log console.
+			if (GEngine)
+			{
+				GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow,
+					FString::Printf(TEXT("Asset %s has already been instanced inside %s scene/level and therefore could not be registered."), *Asset->GetName(),
+						*GetWorld()->GetName()), true);
+			}
+			UE_LOG(LogGameSession, Warning, TEXT("%s has already been instanced inside %s scene/level and therefore could not be registered. Returning already instanced object"),
+					   *Asset->GetName(), *GetWorld()->GetName());
+			return *SingletonHandle;
 		}
 	}
+	
+	UGameFlowAsset* AssetInstance = GetInstancePool(Asset).Acquire(this);
+	if(AssetInstance == nullptr) return FGameFlowInstanceHandle();
+
+	// Reuse free slots first, to keep the registry compact.
+	const int32 SlotIndex = FreeInstanceSlots.Num() > 0? FreeInstanceSlots.Pop() : InstanceSlots.AddDefaulted();
+	FGameFlowInstanceSlot& Slot = InstanceSlots[SlotIndex];
+	Slot.Instance = AssetInstance;
+	Slot.Source = Asset;
+	Slot.DenseIndex = RunningInstances.Add(AssetInstance);
+	INC_DWORD_STAT(STAT_GameFlow_ActiveInstances);
+	
+	const FGameFlowInstanceHandle Handle(SlotIndex, Slot.Generation);
+	AssetInstance->InstanceHandle = Handle;
+	if(Asset->bShouldBeSingleton)
+	{
+		SingletonInstances.Add(Asset, Handle);
+	}
+	
+	// Listen for finish events. It is necessary to know when we need to unregister asset instance.
+	// Recycled instances are still bound from their previous run.
+	if(!AssetInstance->OnFinish.IsBoundToObject(this))
+	{
+		AssetInstance->OnFinish.AddUObject(this, &UGameFlowSubsystem::UnregisterAssetInstance);
+	}
+
+	return Handle;
 }
 
-UGameFlowAsset* UGameFlowSubsystem::RegisterAssetInstance(UGameFlowAsset* Asset)
+void UGameFlowSubsystem::UnregisterAssetInstance(UGameFlowAsset* AssetInstance)
 {
-	UGameFlowAsset* AssetInstance = InstancedAssets.FindRef(Asset);
-	// Create only unique asset instances.
-	if(AssetInstance == nullptr)
+	const FGameFlowInstanceHandle Handle = AssetInstance->InstanceHandle;
+	if(FindSlot(Handle) == nullptr) return;
+
+	FGameFlowInstanceSlot& Slot = InstanceSlots[Handle.GetIndex()];
+	UGameFlowAsset* SourceAsset = Slot.Source;
+	
+	// Keep running instances packed, moving the last one inside the hole.
+	const int32 DenseIndex = Slot.DenseIndex;
+	RunningInstances.RemoveAtSwap(DenseIndex);
+	DEC_DWORD_STAT(STAT_GameFlow_ActiveInstances);
+	if(RunningInstances.IsValidIndex(DenseIndex))
 	{
-		AssetInstance = Asset->CreateInstance(this);
-		InstancedAssets.Add(Asset->GetArchetype(), AssetInstance);
-		
-		// Listen for finish events. It is necessary to know when we need to unregister asset instance.
-		AssetInstance->OnFinish.AddUObject(this, &UGameFlowSubsystem::UnregisterAssetInstance);
+		InstanceSlots[RunningInstances[DenseIndex]->InstanceHandle.GetIndex()].DenseIndex = DenseIndex;
 	}
-	// Print the warning message both on the screen and in the log console.
-	else
+
+	if(SingletonInstances.FindRef(SourceAsset) == Handle)
+	{
+		SingletonInstances.Remove(SourceAsset);
+	}
+	
+	// Free the slot, invalidating all the handles to this instance.
+	Slot.Instance = nullptr;
+	Slot.Source = nullptr;
+	Slot.Owner = FGameFlowInstanceHandle();
+	Slot.DenseIndex = INDEX_NONE;
+	Slot.Generation++;
+	FreeInstanceSlots.Add(Handle.GetIndex());
+	AssetInstance->InstanceHandle = FGameFlowInstanceHandle();
+
+	// Finished instances should not be woken up by their pending timers.
+	TimingWheel.ClearAllTimers(AssetInstance);
+	
+	// Give the instance back to its pool, it will be recycled if possible. Instances finishing
+	// from one of their own nodes are still executing, wait for their work queue to unwind.
+	if(AssetInstance->bIsRunningWorkQueue)
+	{
+		AssetInstance->WorkQueue.Reset();
+		PendingReleases.Add({ AssetInstance, SourceAsset });
+		return;
+	}
+	GetInstancePool(SourceAsset).Release(AssetInstance);
+}
+
+void UGameFlowSubsystem::FlushPendingReleases()
+{
+	for(int32 Index = PendingReleases.Num() - 1; Index >= 0; --Index)
 	{
-		if (GEngine)
+		const FGameFlowPendingRelease PendingRelease = PendingReleases[Index];
+		if(PendingRelease.Instance == nullptr || !PendingRelease.Instance->bIsRunningWorkQueue)
 		{
-			GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow,
-				FString::Printf(TEXT("Asset %s has already been instanced inside %s scene/level and therefore could not be registered."), *Asset->GetName(),
-					*GetWorld()->GetName()), true);
+			PendingReleases.RemoveAtSwap(Index);
+			if(PendingRelease.Instance != nullptr)
+			{
+				GetInstancePool(PendingRelease.Source).Release(PendingRelease.Instance);
+			}
 		}
-		UE_LOG(LogGameSession, Warning, TEXT("%s has already been instanced inside %s scene/level and therefore could not be registered. Returning already instanced object"),
-				   *Asset->GetName(), *GetWorld()->GetName());
 	}
+}
 
-	return AssetInstance;
+void UGameFlowSubsystem::PrewarmInstances(UGameFlowAsset* Asset, int32 Count)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	if(Asset != nullptr && Count > 0)
+	{
+		GetInstancePool(Asset).Prewarm(this, Count);
+	}
 }
 
-void UGameFlowSubsystem::UnregisterAssetInstance(UGameFlowAsset* AssetInstance)
+void UGameFlowSubsystem::CollectMemoryUsage(TMap<const UGameFlowAsset*, FGameFlowAssetMemory>& InOutUsage) const
+{
+	auto AddInstance = [&InOutUsage](const UGameFlowAsset* Source, UGameFlowAsset* Instance)
+	{
+		FGameFlowAssetMemory& Memory = InOutUsage.FindOrAdd(Source);
+		Memory.InstanceBytes += Instance->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		Memory.NumInstances++;
+	};
+	
+	for(UGameFlowAsset* Instance : RunningInstances)
+	{
+		AddInstance(InstanceSlots[Instance->InstanceHandle.GetIndex()].Source, Instance);
+	}
+	for(const auto& [Asset, Pool] : InstancePools)
+	{
+		for(UGameFlowAsset* Instance : Pool.GetFreeInstances())
+		{
+			AddInstance(Asset, Instance);
+		}
+	}
+}
+
+FGameFlowInstancePool& UGameFlowSubsystem::GetInstancePool(UGameFlowAsset* Asset)
 {
-	const UObject* InstanceArchetype = AssetInstance->GetArchetype();
-	InstancedAssets.Remove(InstanceArchetype);
+	FGameFlowInstancePool* Pool = InstancePools.Find(Asset);
+	if(Pool == nullptr)
+	{
+		Pool = &InstancePools.Add(Asset);
+		Pool->Asset = Asset;
+	}
+	return *Pool;
 }
 
 void UGameFlowSubsystem::RegisterListener(UGameFlowListener* Listener)
 {
-	if(Listener != nullptr)
+	LLM_SCOPE_BYTAG(GameFlow_Listeners);
+	if(Listener == nullptr || Listeners.Contains(Listener)) return;
+
+	// Levels being streamed in register all their components at once, wait for the level to be visible.
+	const ULevel* Level = Listener->GetComponentLevel();
+	if(Level != nullptr && Level->bIsAssociatingLevel)
 	{
-		Listeners.Add(Listener);
-		OnListenerComponentRegistered.Broadcast(Listener);
+		PendingListeners.AddUnique(Listener);
+		return;
 	}
+	AddListener(Listener);
+}
+
+void UGameFlowSubsystem::AddListener(UGameFlowListener* Listener)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Listeners);
+	Listeners.Add(Listener);
+	INC_DWORD_STAT(STAT_GameFlow_ActiveListeners);
+	ListenerIndex.AddListener(Listener);
+	if(UGameFlowRuntimeSettings::Get()->bEnableSpatialListenerQueries)
+	{
+		TrackListenerLocation(Listener);
+	}
+	ListenerRouter.DispatchListenerEvent(EGameFlowListenerEvent::Registered, Listener);
+	OnListenerComponentRegistered.Broadcast(Listener);
 }
 
 void UGameFlowSubsystem::UnregisterListener(UGameFlowListener* Listener)
 {
-	if(Listener != nullptr)
+	if(Listener == nullptr) return;
+
+	PendingListeners.RemoveSwap(Listener);
+	if(Listeners.Remove(Listener) > 0)
 	{
-		Listeners.Remove(Listener);
+		DEC_DWORD_STAT(STAT_GameFlow_ActiveListeners);
+		ListenerIndex.RemoveListener(Listener);
+		UntrackListenerLocation(Listener);
+		ListenerRouter.DispatchListenerEvent(EGameFlowListenerEvent::Unregistered, Listener);
 		OnListenerComponentUnregistered.Broadcast(Listener);
 	}
 }
 
-void UGameFlowSubsystem::Execute(UGameFlowAsset* Asset, FName RootName)
+void UGameFlowSubsystem::TrackListenerLocation(UGameFlowListener* Listener)
+{
+	const AActor* Owner = Listener->GetOwner();
+	USceneComponent* RootComponent = Owner != nullptr? Owner->GetRootComponent() : nullptr;
+	if(RootComponent == nullptr) return;
+
+	ListenerGrid.Update(Listener, RootComponent->GetComponentLocation());
+	const FDelegateHandle Handle = RootComponent->TransformUpdated.AddUObject(this, &UGameFlowSubsystem::OnListenerMoved, Listener);
+	TrackedListenerComponents.Add(Listener, { RootComponent, Handle });
+}
+
+void UGameFlowSubsystem::UntrackListenerLocation(UGameFlowListener* Listener)
+{
+	TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle> TrackedComponent;
+	if(TrackedListenerComponents.RemoveAndCopyValue(Listener, TrackedComponent))
+	{
+		USceneComponent* RootComponent = TrackedComponent.Key.Get();
+		if(RootComponent != nullptr)
+		{
+			RootComponent->TransformUpdated.Remove(TrackedComponent.Value);
+		}
+		ListenerGrid.Remove(Listener);
+	}
+}
+
+void UGameFlowSubsystem::OnListenerMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+	ETeleportType Teleport, UGameFlowListener* Listener)
+{
+	ListenerGrid.Update(Listener, UpdatedComponent->GetComponentLocation());
+}
+
+void UGameFlowSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Listeners);
+	if(World != GetWorld() || PendingListeners.IsEmpty()) return;
+
+	TArray<TObjectPtr<UGameFlowListener>> LevelListeners;
+	for(int32 Index = PendingListeners.Num() - 1; Index >= 0; --Index)
+	{
+		UGameFlowListener* Listener = PendingListeners[Index];
+		if(Listener == nullptr || Listener->GetComponentLevel() == Level)
+		{
+			if(Listener != nullptr)
+			{
+				LevelListeners.Add(Listener);
+			}
+			PendingListeners.RemoveAtSwap(Index);
+		}
+	}
+	
+	Listeners.Reserve(Listeners.Num() + LevelListeners.Num());
+	for(UGameFlowListener* Listener : LevelListeners)
+	{
+		AddListener(Listener);
+	}
+}
+
+void UGameFlowSubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
 {
-	UGameFlowAsset* RuntimeAsset = RegisterAssetInstance(Asset);
+	if(World != GetWorld()) return;
+
+	// Listeners of a level being removed skip their own unregistration, drop them all in one pass.
+	// Entries nulled by the garbage collector are still hashed with their former pointer, Remove(nullptr)
+	// would not find them: drop them through the iterator, which does not rely on their hash.
+	TArray<UGameFlowListener*> LevelListeners;
+	int32 NumDestroyedListeners = 0;
+	for(auto It = Listeners.CreateIterator(); It; ++It)
+	{
+		UGameFlowListener* Listener = *It;
+		if(Listener == nullptr)
+		{
+			It.RemoveCurrent();
+			NumDestroyedListeners++;
+		}
+		else if(Level == nullptr || Listener->GetComponentLevel() == Level)
+		{
+			LevelListeners.Add(Listener);
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_GameFlow_ActiveListeners, NumDestroyedListeners);
+	
+	for(UGameFlowListener* Listener : LevelListeners)
+	{
+		UnregisterListener(Listener);
+	}
+}
+
+void UGameFlowSubsystem::AddListenerTag(UGameFlowListener* Listener, FGameplayTag Tag)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Listeners);
+	ListenerIndex.AddTag(Listener, Tag);
+	ListenerRouter.DispatchTagEvent(EGameFlowListenerEvent::TagAdded, Listener, Tag);
+	OnGameplayTagAdded.Broadcast(Listener, Tag);
+}
+
+void UGameFlowSubsystem::RemoveListenerTag(UGameFlowListener* Listener, FGameplayTag Tag)
+{
+	ListenerIndex.RemoveTag(Listener, Tag);
+	ListenerRouter.DispatchTagEvent(EGameFlowListenerEvent::TagRemoved, Listener, Tag);
+	OnGameplayTagRemoved.Broadcast(Listener, Tag);
+}
+
+FGameFlowListenerSubscriptionHandle UGameFlowSubsystem::SubscribeToListenerEvents(const FGameplayTagContainer& Tags,
+	FOnGameFlowListenerEvent Delegate)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Listeners);
+	return ListenerRouter.Subscribe(Tags, MoveTemp(Delegate));
+}
+
+void UGameFlowSubsystem::UnsubscribeFromListenerEvents(FGameFlowListenerSubscriptionHandle& Handle)
+{
+	ListenerRouter.Unsubscribe(Handle);
+}
+
+FGameFlowInstanceHandle UGameFlowSubsystem::Execute(UGameFlowAsset* Asset, FName RootName)
+{
+	const FGameFlowInstanceHandle Handle = RegisterAssetInstance(Asset);
+	UGameFlowAsset* RuntimeAsset = GetInstance(Handle);
     // Has the asset been registered successfully?
 	if(RuntimeAsset != nullptr)
 	{
 		RuntimeAsset->Execute(RootName);
 	}
+	return Handle;
+}
+
+void UGameFlowSubsystem::SetInstanceOwner(FGameFlowInstanceHandle Handle, FGameFlowInstanceHandle OwnerHandle)
+{
+	if(FindSlot(Handle) != nullptr && Handle != OwnerHandle)
+	{
+		InstanceSlots[Handle.GetIndex()].Owner = OwnerHandle;
+	}
+}
+
+const FGameFlowInstanceSlot* UGameFlowSubsystem::FindSlot(FGameFlowInstanceHandle Handle) const
+{
+	if(!InstanceSlots.IsValidIndex(Handle.GetIndex())) return nullptr;
+
+	const FGameFlowInstanceSlot& Slot = InstanceSlots[Handle.GetIndex()];
+	return Slot.Generation == Handle.GetGeneration() && Slot.Instance != nullptr? &Slot : nullptr;
+}
+
+UGameFlowAsset* UGameFlowSubsystem::GetInstance(FGameFlowInstanceHandle Handle) const
+{
+	const FGameFlowInstanceSlot* Slot = FindSlot(Handle);
+	return Slot != nullptr? Slot->Instance.Get() : nullptr;
+}
+
+bool UGameFlowSubsystem::IsInstanceRunning(FGameFlowInstanceHandle Handle) const
+{
+	return FindSlot(Handle) != nullptr;
+}
+
+bool UGameFlowSubsystem::SaveInstance(FGameFlowInstanceHandle Handle, TArray<uint8>& OutData)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	OutData.Reset();
+	UGameFlowAsset* Instance = GetInstance(Handle);
+	return Instance != nullptr && Instance->SaveSnapshot(OutData);
+}
+
+FGameFlowInstanceHandle UGameFlowSubsystem::RestoreInstance(UGameFlowAsset* Asset, const TArray<uint8>& Data)
+{
+	const FGameFlowInstanceHandle Handle = RegisterAssetInstance(Asset);
+	UGameFlowAsset* Instance = GetInstance(Handle);
+	if(Instance == nullptr) return FGameFlowInstanceHandle();
+
+	if(!Instance->RestoreSnapshot(Data))
+	{
+		StopInstance(Handle);
+		return FGameFlowInstanceHandle();
+	}
+	return Handle;
+}
+
+void UGameFlowSubsystem::RequestAutosave(bool bFull, FOnGameFlowAutosaved OnComplete)
+{
+	// A newer request replaces the pending one, keeping it full if either was.
+	const bool bWasFull = PendingAutosave.IsSet() && PendingAutosave->Key;
+	PendingAutosave.Emplace(bFull || bWasFull, MoveTemp(OnComplete));
+}
+
+void UGameFlowSubsystem::CaptureAutosave()
+{
+	LLM_SCOPE_BYTAG(GameFlow_Instances);
+	// Deltas need a previous autosave to be applied on.
+	const bool bFull = PendingAutosave->Key || !Autosaver.HasPreviousAutosave();
+	FOnGameFlowAutosaved OnComplete = MoveTemp(PendingAutosave->Value);
+	PendingAutosave.Reset();
+
+	// Only the instances which changed are copied on the game thread, encoding and compression happen in the background.
+	TArray<TPair<uint64, FGameFlowSavedInstance>> ChangedInstances;
+	TSet<uint64> RunningKeys;
+	RunningKeys.Reserve(RunningInstances.Num());
+	
+	// Owned instances are written nested inside the snapshot of their owner, a change to them is a change to it.
+	for(UGameFlowAsset* Instance : RunningInstances)
+	{
+		if(!Instance->bIsSnapshotDirty && !TimingWheel.HasRunningTimers(Instance)) continue;
+
+		const FGameFlowInstanceSlot* OwnerSlot = FindSlot(InstanceSlots[Instance->InstanceHandle.GetIndex()].Owner);
+		while(OwnerSlot != nullptr && !OwnerSlot->Instance->bIsSnapshotDirty)
+		{
+			OwnerSlot->Instance->bIsSnapshotDirty = true;
+			OwnerSlot = FindSlot(OwnerSlot->Owner);
+		}
+	}
+	
+	for(UGameFlowAsset* Instance : RunningInstances)
+	{
+		const FGameFlowInstanceHandle Handle = Instance->InstanceHandle;
+		const bool bIsDirty = Instance->bIsSnapshotDirty || TimingWheel.HasRunningTimers(Instance);
+		Instance->bIsSnapshotDirty = false;
+		if(FindSlot(InstanceSlots[Handle.GetIndex()].Owner) != nullptr) continue;
+		
+		const uint64 Key = static_cast<uint64>(Handle.GetIndex()) << 32 | Handle.GetGeneration();
+		RunningKeys.Add(Key);
+		if(!bFull && !bIsDirty) continue;
+
+		FGameFlowSavedInstance SavedInstance;
+		SavedInstance.Asset = InstanceSlots[Handle.GetIndex()].Source;
+		if(Instance->SaveSnapshot(SavedInstance.Snapshot))
+		{
+			ChangedInstances.Emplace(Key, MoveTemp(SavedInstance));
+		}
+	}
+	
+	Autosaver.Encode(MoveTemp(ChangedInstances), MoveTemp(RunningKeys), bFull, MoveTemp(OnComplete));
+}
+
+void UGameFlowSubsystem::StopInstance(FGameFlowInstanceHandle Handle)
+{
+	UGameFlowAsset* Instance = GetInstance(Handle);
+	if(Instance != nullptr)
+	{
+		// Finish events will unregister the instance.
+		Instance->TerminateExecution();
+	}
 }
 
 TArray<UGameFlowAsset*> UGameFlowSubsystem::GetRunningFlows() const
 {
-	TArray<UGameFlowAsset*> RunningAssets;
-	InstancedAssets.GenerateValueArray(RunningAssets);
-	return RunningAssets;
+	return RunningInstances;
 }
 
 UGameFlowAsset* UGameFlowSubsystem::GetRunningFlowByArchetype(UObject* Archetype) const
 {
-	return InstancedAssets.FindRef(Archetype);
+	for(const UGameFlowAsset* Instance : RunningInstances)
+	{
+		const FGameFlowInstanceSlot& Slot = InstanceSlots[Instance->InstanceHandle.GetIndex()];
+		if(Slot.Source == Archetype)
+		{
+			return Slot.Instance;
+		}
+	}
+	return nullptr;
 }
 
 TArray<UGameFlowListener*> UGameFlowSubsystem::GetListenersByGameplayTags(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType) const
 {
-	TArray<UGameFlowListener*> QueriedListeners = Listeners.FilterByPredicate([=] (const UGameFlowListener* Listener)
-	{
-		const FGameplayTagContainer Tags = Listener->IdentityTags;
-		return MatchType == EGameplayContainerMatchType::All? Tags.HasAll(GameplayTag) : Tags.HasAny(GameplayTag);
-	});
+	TArray<UGameFlowListener*> QueriedListeners;
+	ListenerIndex.Query(GameplayTag, MatchType, QueriedListeners);
 	return QueriedListeners;
 }
 
+void UGameFlowSubsystem::QueryListeners(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType,
+	TArray<UGameFlowListener*>& OutListeners) const
+{
+	ListenerIndex.Query(GameplayTag, MatchType, OutListeners);
+}
+
+TArray<UGameFlowListener*> UGameFlowSubsystem::GetListenersByGameplayTagsInRadius(FGameplayTagContainer GameplayTag,
+	EGameplayContainerMatchType MatchType, FVector Center, float Radius) const
+{
+	TArray<UGameFlowListener*> QueriedListeners;
+	QueryListenersInRadius(GameplayTag, MatchType, Center, Radius, QueriedListeners);
+	return QueriedListeners;
+}
+
+TArray<UGameFlowListener*> UGameFlowSubsystem::GetListenersByGameplayTagsInBox(FGameplayTagContainer GameplayTag,
+	EGameplayContainerMatchType MatchType, FBox Box) const
+{
+	TArray<UGameFlowListener*> QueriedListeners;
+	QueryListenersInBox(GameplayTag, MatchType, Box, QueriedListeners);
+	return QueriedListeners;
+}
+
+namespace
+{
+	/** Keep only the listeners matching the tags query, among the ones appended after the first index. */
+	void FilterListenersByTags(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType,
+		TArray<UGameFlowListener*>& Listeners, int32 FirstIndex)
+	{
+		const FGameFlowTagMask QueryMask = FGameFlowTagMask::Make(GameplayTag, false);
+		for(int32 Index = Listeners.Num() - 1; Index >= FirstIndex; --Index)
+		{
+			if(!Listeners[Index]->MatchesTags(GameplayTag, QueryMask, MatchType))
+			{
+				Listeners.RemoveAtSwap(Index);
+			}
+		}
+	}
+
+	/** Keep only the listeners whose owner is inside the area, among the ones appended after the first index. */
+	void FilterListenersByLocation(TFunctionRef<bool(const FVector&)> IsInside, TArray<UGameFlowListener*>& Listeners, int32 FirstIndex)
+	{
+		for(int32 Index = Listeners.Num() - 1; Index >= FirstIndex; --Index)
+		{
+			const AActor* Owner = Listeners[Index]->GetOwner();
+			if(Owner == nullptr || !IsInside(Owner->GetActorLocation()))
+			{
+				Listeners.RemoveAtSwap(Index);
+			}
+		}
+	}
+}
+
+void UGameFlowSubsystem::QueryListenersInRadius(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType,
+	const FVector& Center, float Radius, TArray<UGameFlowListener*>& OutListeners) const
+{
+	const int32 FirstIndex = OutListeners.Num();
+	if(UGameFlowRuntimeSettings::Get()->bEnableSpatialListenerQueries)
+	{
+		ListenerGrid.QuerySphere(Center, Radius, OutListeners);
+		FilterListenersByTags(GameplayTag, MatchType, OutListeners, FirstIndex);
+		return;
+	}
+
+	// Without the grid, filter the listeners matching the tags by distance.
+	QueryListeners(GameplayTag, MatchType, OutListeners);
+	const double RadiusSquared = FMath::Square(Radius);
+	FilterListenersByLocation([&](const FVector& Location)
+	{
+		return FVector::DistSquared(Center, Location) <= RadiusSquared;
+	}, OutListeners, FirstIndex);
+}
+
+void UGameFlowSubsystem::QueryListenersInBox(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType,
+	const FBox& Box, TArray<UGameFlowListener*>& OutListeners) const
+{
+	const int32 FirstIndex = OutListeners.Num();
+	if(UGameFlowRuntimeSettings::Get()->bEnableSpatialListenerQueries)
+	{
+		ListenerGrid.QueryBox(Box, OutListeners);
+		FilterListenersByTags(GameplayTag, MatchType, OutListeners, FirstIndex);
+		return;
+	}
+	
+	QueryListeners(GameplayTag, MatchType, OutListeners);
+	FilterListenersByLocation([&Box](const FVector& Location)
+	{
+		return Box.IsInsideOrOn(Location);
+	}, OutListeners, FirstIndex);
+}
+
 void UGameFlowSubsystem::NotifyListeners(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType)
 {
-	TArray<UGameFlowListener*> QueriedListeners = GetListenersByGameplayTags(GameplayTag, MatchType);
+	FGameFlowBusEvent Event;
+	Event.Tags = MoveTemp(GameplayTag);
+	Event.MatchType = MatchType;
+	SendNotification(MoveTemp(Event));
+}
+
+void UGameFlowSubsystem::NotifyListenersInRadius(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType,
+	FVector Center, float Radius)
+{
+	FGameFlowBusEvent Event;
+	Event.Tags = MoveTemp(GameplayTag);
+	Event.MatchType = MatchType;
+	Event.Sphere = FSphere(Center, FMath::Max(Radius, UE_KINDA_SMALL_NUMBER));
+	SendNotification(MoveTemp(Event));
+}
+
+void UGameFlowSubsystem::NotifyListenersInBox(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType, FBox Box)
+{
+	// Invalid boxes contain nothing, do not let them fall back to notifying the whole world.
+	if(!Box.IsValid) return;
+	
+	FGameFlowBusEvent Event;
+	Event.Tags = MoveTemp(GameplayTag);
+	Event.MatchType = MatchType;
+	Event.Box = Box;
+	SendNotification(MoveTemp(Event));
+}
+
+void UGameFlowSubsystem::NotifyFromListener(UGameFlowListener* Listener, const FGameplayTagContainer& GameplayTags)
+{
+	if(Listener == nullptr) return;
+	
+	FGameFlowBusEvent Event;
+	Event.Sender = Listener;
+	Event.Tags = GameplayTags;
+	SendNotification(MoveTemp(Event));
+}
+
+void UGameFlowSubsystem::SendNotification(FGameFlowBusEvent&& Event)
+{
+	LLM_SCOPE_BYTAG(GameFlow_Listeners);
+	if(!UGameFlowRuntimeSettings::Get()->bCoalesceListenerEvents || !EventBus.Enqueue(MoveTemp(Event)))
+	{
+		DispatchNotification(Event);
+	}
+}
+
+void UGameFlowSubsystem::DispatchNotification(const FGameFlowBusEvent& Event)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GameFlow_NotifyListeners);
+	TGuardValue<int32> OccurrencesGuard(DispatchedEventOccurrences, Event.Occurrences);
+	
+	// Notifications sent by a listener go to all the nodes listening to it.
+	if(!Event.Sender.IsExplicitlyNull())
+	{
+		// The sender may have been destroyed while its notification was buffered.
+		UGameFlowListener* Sender = Event.Sender.Get();
+		if(Sender != nullptr)
+		{
+			Sender->OnNotifyGameFlowListener.Broadcast(Event.Tags);
+		}
+		return;
+	}
+	
+	// Take the scratch array, so that notifications sent by the receivers get a clean one.
+	TArray<UGameFlowListener*> QueriedListeners = MoveTemp(DispatchedListeners);
+	QueriedListeners.Reset();
+	if(Event.Box.IsValid)
+	{
+		QueryListenersInBox(Event.Tags, Event.MatchType, Event.Box, QueriedListeners);
+	}
+	else if(Event.Sphere.W > 0.0)
+	{
+		QueryListenersInRadius(Event.Tags, Event.MatchType, Event.Sphere.Center, Event.Sphere.W, QueriedListeners);
+	}
+	else
+	{
+		QueryListeners(Event.Tags, Event.MatchType, QueriedListeners);
+	}
 	// Broadcast game flow event to all listeners.
 	for(const UGameFlowListener* Listener : QueriedListeners)
 	{
 		if(Listener->OnReceiveGameFlowEvent.IsBound())
 		{
-			Listener->OnReceiveGameFlowEvent.Broadcast(GameplayTag);
+			Listener->OnReceiveGameFlowEvent.Broadcast(Event.Tags);
 		}
 	}
+	DispatchedListeners = MoveTemp(QueriedListeners);
 }
 
 
@@ -0,0 +1,72 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GameFlowTagMask.h"
+#include "GameplayTagsManager.h"
+
+namespace
+{
+	/** Bit index assigned to each registered tag. Only written by BuildTagBits, lookups are read-only. */
+	TMap<FGameplayTag, int32>& GetTagBits()
+	{
+		static TMap<FGameplayTag, int32> TagBits;
+		return TagBits;
+	}
+}
+
+void FGameFlowTagMask::BuildTagBits()
+{
+	check(IsInGameThread());
+	FGameplayTagContainer AllTags;
+	UGameplayTagsManager::Get().RequestAllGameplayTags(AllTags, false);
+
+	TMap<FGameplayTag, int32>& TagBits = GetTagBits();
+	TagBits.Reserve(FMath::Min(AllTags.Num(), MaxTags));
+	for (const FGameplayTag& Tag : AllTags)
+	{
+		if (TagBits.Num() >= MaxTags) break;
+		if (!TagBits.Contains(Tag))
+		{
+			TagBits.Add(Tag, TagBits.Num());
+		}
+	}
+}
+
+int32 FGameFlowTagMask::GetTagBit(FGameplayTag Tag)
+{
+	const int32* Bit = GetTagBits().Find(Tag);
+	return Bit != nullptr? *Bit : INDEX_NONE;
+}
+
+FGameFlowTagMask FGameFlowTagMask::Make(const FGameplayTagContainer& Tags, bool bExpandParents)
+{
+	FGameFlowTagMask Mask;
+	auto AddTag = [&Mask](FGameplayTag Tag)
+	{
+		const int32 Bit = GetTagBit(Tag);
+		if (Bit != INDEX_NONE)
+		{
+			Mask.SetBit(Bit);
+		}
+		else
+		{
+			Mask.bOverflow = true;
+		}
+	};
+	
+	if (bExpandParents)
+	{
+		const FGameplayTagContainer ExpandedTags = Tags.GetGameplayTagParents();
+		for (const FGameplayTag& Tag : ExpandedTags)
+		{
+			AddTag(Tag);
+		}
+	}
+	else
+	{
+		for (const FGameplayTag& Tag : Tags)
+		{
+			AddTag(Tag);
+		}
+	}
+	return Mask;
+}
@@ -3,11 +3,14 @@
 #include "Nodes/Debug/GameFlowNode_Debug_Log.h"
 #include "GameFramework/GameSession.h"
 
+const TGameFlowPins<UGameFlowNode_Debug_Log::EInputPin> UGameFlowNode_Debug_Log::InputPins({ TEXT("Exec") });
+const TGameFlowPins<UGameFlowNode_Debug_Log::EOutputPin> UGameFlowNode_Debug_Log::OutputPins({ TEXT("Out") });
+
 UGameFlowNode_Debug_Log::UGameFlowNode_Debug_Log()
 {
 #if WITH_EDITOR
-	AddInputPin_CDO("Exec");
-	AddOutputPin_CDO("Out");
+	AddInputPin_CDO(InputPins[EInputPin::Exec]);
+	AddOutputPin_CDO(OutputPins[EOutputPin::Out]);
 	TypeName = "Debug";
 #endif
 	
@@ -39,5 +42,5 @@ void UGameFlowNode_Debug_Log::OnFinishExecute_Implementation()
 	Super::OnFinishExecute_Implementation();
 
 	// Execute default output pin.
-	TriggerOutputPin("Out");
+	TriggerOutputPin(EOutputPin::Out);
 }
@@ -2,36 +2,53 @@
 
 #include "Nodes/Flow/GameFlowNode_FlowControl_DoN.h"
 
+const TGameFlowPins<UGameFlowNode_FlowControl_DoN::EInputPin> UGameFlowNode_FlowControl_DoN::InputPins(
+	{ TEXT("Enter"), TEXT("Reset") });
+
+const TGameFlowPins<UGameFlowNode_FlowControl_DoN::EOutputPin> UGameFlowNode_FlowControl_DoN::OutputPins(
+	{ TEXT("Exit") });
+
 UGameFlowNode_FlowControl_DoN::UGameFlowNode_FlowControl_DoN()
 {
 #if WITH_EDITOR
 	// Initialize input pins.
-	AddInputPin_CDO("Enter");
-	AddInputPin_CDO("Reset");
+	for(const FName& PinName : InputPins.GetNames())
+	{
+		AddInputPin_CDO(PinName);
+	}
 	
     // Initialize output pins.
-	AddOutputPin_CDO("Exit");
+	for(const FName& PinName : OutputPins.GetNames())
+	{
+		AddOutputPin_CDO(PinName);
+	}
 
 	TypeName = "Conditional";
 #endif
 	
 	N = 1;
-	Count = 0;
 }
 
 void UGameFlowNode_FlowControl_DoN::Execute_Implementation(const FName PinName)
 {
 	Super::Execute_Implementation(PinName);
+	ExecutePin(InputPins.IndexOf(PinName), PinName);
+}
+
+void UGameFlowNode_FlowControl_DoN::ExecutePin(int32 PinIndex, FName PinName)
+{
+	FGameFlowNode_FlowControl_DoN_State* State = GetInstanceState<FGameFlowNode_FlowControl_DoN_State>();
+	if(State == nullptr) return;
 	
 	// Reset the counter.
-	if(PinName.IsEqual("Reset"))
+	if(static_cast<EInputPin>(PinIndex) == EInputPin::Reset)
 	{
-		Count = 0;
+		State->Count = 0;
 	}
-	else if(Count <= N)
+	else if(State->Count <= N)
 	{
-		Count++;
-		TriggerOutputPin("Exit");
+		State->Count++;
+		TriggerOutputPin(EOutputPin::Exit);
 	}
 	FinishExecute(true);
 }
@@ -44,3 +61,17 @@ void UGameFlowNode_FlowControl_DoN::OnFinishExecute_Implementation()
 	TriggerOutputPin("Out");
 }
 
+#if WITH_EDITOR
+
+FString UGameFlowNode_FlowControl_DoN::GetCustomDebugInfo() const
+{
+	const FGameFlowNode_FlowControl_DoN_State* State = GetInstanceState<FGameFlowNode_FlowControl_DoN_State>();
+	if(State != nullptr)
+	{
+		return FString::Printf(TEXT("Count: %u \n"), State->Count);
+	}
+	return "";
+}
+
+#endif
+
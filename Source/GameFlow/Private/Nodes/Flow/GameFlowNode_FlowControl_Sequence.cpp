@@ -1,6 +1,7 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Nodes/Flow/GameFlowNode_FlowControl_Sequence.h"
+#include "GameFlowAsset.h"
 
 UGameFlowNode_FlowControl_Sequence::UGameFlowNode_FlowControl_Sequence()
 {
@@ -17,10 +18,12 @@ void UGameFlowNode_FlowControl_Sequence::Execute_Implementation(const FName PinN
 {
 	Super::Execute_Implementation(PinName);
 
+	UGameFlowAsset* OwnerAsset = GetOwnerInstance();
+	const FGameFlowProgramNode& ProgramNode = OwnerAsset->GetProgram().Nodes[ProgramIndex];
+	
 	// Execute all the output pins in order.
-	for(const auto& KeyValuePair : Outputs)
+	for(int32 PinIndex = ProgramNode.FirstOutput; PinIndex < ProgramNode.FirstOutput + ProgramNode.NumOutputs; ++PinIndex)
 	{
-		UOutPinHandle* PinHandle = KeyValuePair.Value;
-		PinHandle->TriggerPin();
+		OwnerAsset->TriggerOutputPin(PinIndex);
 	}
 }
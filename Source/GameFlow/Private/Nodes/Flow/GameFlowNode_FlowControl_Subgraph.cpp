@@ -2,7 +2,9 @@
 
 #include "Nodes/Flow/GameFlowNode_FlowControl_Subgraph.h"
 #include "GameFlowSubsystem.h"
-#include "Engine/StreamableManager.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/GameSession.h"
 
 UGameFlowNode_FlowControl_Subgraph::UGameFlowNode_FlowControl_Subgraph()
 {
@@ -14,7 +16,187 @@ UGameFlowNode_FlowControl_Subgraph::UGameFlowNode_FlowControl_Subgraph()
 void UGameFlowNode_FlowControl_Subgraph::Execute_Implementation(const FName PinName)
 {
 	Super::Execute_Implementation(PinName);
-	InstancedAsset->Execute(PinName);
+
+	// Never block on disk, wait for the subgraph to be loaded.
+	if(Asset.Get() != nullptr)
+	{
+		EnterSubgraph(PinName);
+	}
+	else
+	{
+		FGameFlowNode_FlowControl_Subgraph_State* State = GetInstanceState<FGameFlowNode_FlowControl_Subgraph_State>();
+		if(State == nullptr) return;
+		
+		State->PendingEntries.Add(PinName);
+		RequestLoad(*State);
+	}
+}
+
+void UGameFlowNode_FlowControl_Subgraph::Preload()
+{
+	FGameFlowNode_FlowControl_Subgraph_State* State = GetInstanceState<FGameFlowNode_FlowControl_Subgraph_State>();
+	if(State != nullptr)
+	{
+		RequestLoad(*State);
+	}
+}
+
+void UGameFlowNode_FlowControl_Subgraph::ReleaseInstanceState(void* State) const
+{
+	FGameFlowNode_FlowControl_Subgraph_State* SubgraphState = static_cast<FGameFlowNode_FlowControl_Subgraph_State*>(State);
+	if(SubgraphState->LoadHandle.IsValid())
+	{
+		SubgraphState->LoadHandle->CancelHandle();
+		SubgraphState->LoadHandle.Reset();
+	}
+	
+	UGameFlowSubsystem* Subsystem = GetGameFlowSubsystem();
+	if(Subsystem != nullptr)
+	{
+		Subsystem->StopInstance(SubgraphState->RunningInstance);
+	}
+}
+
+void UGameFlowNode_FlowControl_Subgraph::RequestLoad(FGameFlowNode_FlowControl_Subgraph_State& State)
+{
+	if(State.LoadHandle.IsValid() || Asset.IsNull()) return;
+
+	// Loading completes outside of the instance execution, re-enter it before resuming.
+	TWeakObjectPtr<UGameFlowAsset> WeakInstance = GetOwnerInstance();
+	State.LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(Asset.ToSoftObjectPath(),
+		FStreamableDelegate::CreateWeakLambda(this, [this, WeakInstance]()
+		{
+			UGameFlowAsset* Instance = WeakInstance.Get();
+			if(Instance != nullptr)
+			{
+				FGameFlowInstanceScope InstanceScope(Instance);
+				OnSubgraphLoaded();
+			}
+		}));
+}
+
+void UGameFlowNode_FlowControl_Subgraph::OnSubgraphLoaded()
+{
+	FGameFlowNode_FlowControl_Subgraph_State* State = GetInstanceState<FGameFlowNode_FlowControl_Subgraph_State>();
+	if(State == nullptr) return;
+	
+	UGameFlowAsset* SubgraphAsset = Asset.Get();
+	if(SubgraphAsset == nullptr)
+	{
+		UE_LOG(LogGameSession, Error, TEXT("%s could not load subgraph %s"), *GetName(), *Asset.ToString());
+		State->PendingEntries.Reset();
+		State->PendingSnapshot.Reset();
+		return;
+	}
+
+	UGameFlowSubsystem* Subsystem = GetGameFlowSubsystem();
+	if(Subsystem != nullptr && State->PendingSnapshot.Num() > 0)
+	{
+		State->RunningInstance = Subsystem->RestoreInstance(SubgraphAsset, State->PendingSnapshot);
+		State->PendingSnapshot.Reset();
+		Subsystem->SetInstanceOwner(State->RunningInstance, GetOwnerInstance()->GetInstanceHandle());
+		BindSubgraphExits(Subsystem->GetInstance(State->RunningInstance));
+	}
+	
+	// Have an instance ready for when execution reaches this node.
+	if(Subsystem != nullptr && !Subsystem->IsInstanceRunning(State->RunningInstance))
+	{
+		Subsystem->PrewarmInstances(SubgraphAsset, 1);
+	}
+
+	const TArray<FName> PendingEntries = MoveTemp(State->PendingEntries);
+	for(const FName& EntryPointName : PendingEntries)
+	{
+		EnterSubgraph(EntryPointName);
+	}
+}
+
+void UGameFlowNode_FlowControl_Subgraph::EnterSubgraph(FName EntryPointName)
+{
+	UGameFlowSubsystem* Subsystem = GetGameFlowSubsystem();
+	if(Subsystem == nullptr) return;
+	
+	FGameFlowNode_FlowControl_Subgraph_State* State = GetInstanceState<FGameFlowNode_FlowControl_Subgraph_State>();
+	if(State == nullptr) return;
+	
+	UGameFlowAsset* SubgraphInstance = Subsystem->GetInstance(State->RunningInstance);
+	if(SubgraphInstance == nullptr)
+	{
+		State->RunningInstance = Subsystem->RegisterAssetInstance(Asset.Get());
+		SubgraphInstance = Subsystem->GetInstance(State->RunningInstance);
+		if(SubgraphInstance == nullptr) return;
+		
+		// The subgraph instance is saved inside the snapshot of this one.
+		Subsystem->SetInstanceOwner(State->RunningInstance, GetOwnerInstance()->GetInstanceHandle());
+		BindSubgraphExits(SubgraphInstance);
+	}
+	
+	SubgraphInstance->Execute(EntryPointName);
+}
+
+void UGameFlowNode_FlowControl_Subgraph::BindSubgraphExits(UGameFlowAsset* SubgraphInstance)
+{
+	if(SubgraphInstance == nullptr) return;
+	
+	// Exit points of the subgraph continue the execution of this graph.
+	TWeakObjectPtr<UGameFlowAsset> WeakInstance = GetOwnerInstance();
+	SubgraphInstance->OnExitPoint.AddWeakLambda(this, [this, WeakInstance](UGameFlowAsset*, FName ExitPointName)
+	{
+		UGameFlowAsset* Instance = WeakInstance.Get();
+		if(Instance != nullptr)
+		{
+			FGameFlowInstanceScope InstanceScope(Instance);
+			OnSubgraphExit(ExitPointName);
+		}
+	});
+}
+
+void UGameFlowNode_FlowControl_Subgraph::SerializeInstanceState(FArchive& Ar, void* State)
+{
+	FGameFlowNode_FlowControl_Subgraph_State* SubgraphState = static_cast<FGameFlowNode_FlowControl_Subgraph_State*>(State);
+	UGameFlowSubsystem* Subsystem = GetGameFlowSubsystem();
+
+	// The running subgraph instance is written as a nested snapshot.
+	TArray<uint8> SubgraphSnapshot;
+	if(Ar.IsSaving())
+	{
+		if(SubgraphState->PendingSnapshot.Num() > 0)
+		{
+			SubgraphSnapshot = SubgraphState->PendingSnapshot;
+		}
+		else if(Subsystem != nullptr)
+		{
+			Subsystem->SaveInstance(SubgraphState->RunningInstance, SubgraphSnapshot);
+		}
+	}
+	Ar << SubgraphSnapshot << SubgraphState->PendingEntries;
+
+	if(Ar.IsLoading() && (SubgraphSnapshot.Num() > 0 || SubgraphState->PendingEntries.Num() > 0))
+	{
+		SubgraphState->PendingSnapshot = MoveTemp(SubgraphSnapshot);
+		if(Asset.Get() != nullptr)
+		{
+			OnSubgraphLoaded();
+		}
+		else
+		{
+			RequestLoad(*SubgraphState);
+		}
+	}
+}
+
+void UGameFlowNode_FlowControl_Subgraph::OnSubgraphExit(FName ExitPointName)
+{
+	TriggerOutputPin(ExitPointName);
+	// Reaching an exit point terminates the subgraph instance.
+	FinishExecute(true);
+}
+
+UGameFlowSubsystem* UGameFlowNode_FlowControl_Subgraph::GetGameFlowSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	const UGameInstance* GameInstance = World != nullptr? World->GetGameInstance() : nullptr;
+	return GameInstance != nullptr? GameInstance->GetSubsystem<UGameFlowSubsystem>() : nullptr;
 }
 
 #if WITH_EDITOR
@@ -32,12 +214,8 @@ void UGameFlowNode_FlowControl_Subgraph::PostEditChangeProperty(FPropertyChanged
 		// Loaded asset should be of a different class.
 		if(CanInstanceAssetFromSource(LoadedAsset))
 		{
-			// Create an instance of the loaded asset and register it inside game flow.
-			InstancedAsset = LoadedAsset->CreateInstance(this);
-		
-			// Once we've done initializing the instance, it is time to
-			// rebuild modified subgraph to match instanced asset I/O pins.
-			ReconstructSubgraph();
+			// Rebuild modified subgraph to match the asset I/O pins.
+			ReconstructSubgraph(LoadedAsset);
 
 			// Call this to update graph node look.
 			OnAssetRedirected.Broadcast();
@@ -49,20 +227,20 @@ void UGameFlowNode_FlowControl_Subgraph::PostEditChangeProperty(FPropertyChanged
 	}
 }
 
-void UGameFlowNode_FlowControl_Subgraph::ReconstructSubgraph()
+void UGameFlowNode_FlowControl_Subgraph::ReconstructSubgraph(const UGameFlowAsset* SubgraphAsset)
 {
 	Inputs.Empty();
 	Outputs.Empty();
-	ConstructInputPins();
-	ConstructOutputPins();
+	ConstructInputPins(SubgraphAsset);
+	ConstructOutputPins(SubgraphAsset);
 }
 
-void UGameFlowNode_FlowControl_Subgraph::ConstructInputPins()
+void UGameFlowNode_FlowControl_Subgraph::ConstructInputPins(const UGameFlowAsset* SubgraphAsset)
 {
-	if(InstancedAsset != nullptr)
+	if(SubgraphAsset != nullptr)
 	{
 		TArray<FName> SubgraphInputPins;
-		InstancedAsset->CustomInputs.GenerateKeyArray(SubgraphInputPins);
+		SubgraphAsset->CustomInputs.GenerateKeyArray(SubgraphInputPins);
 		for(const FName& PinName : SubgraphInputPins)
 		{
 			AddPin(PinName, EGPD_Input);
@@ -70,12 +248,12 @@ void UGameFlowNode_FlowControl_Subgraph::ConstructInputPins()
 	}
 }
 
-void UGameFlowNode_FlowControl_Subgraph::ConstructOutputPins()
+void UGameFlowNode_FlowControl_Subgraph::ConstructOutputPins(const UGameFlowAsset* SubgraphAsset)
 {
-	if(InstancedAsset != nullptr)
+	if(SubgraphAsset != nullptr)
 	{
 		TArray<FName> SubgraphOutputPins;
-		InstancedAsset->CustomOutputs.GenerateKeyArray(SubgraphOutputPins);
+		SubgraphAsset->CustomOutputs.GenerateKeyArray(SubgraphOutputPins);
 		for(const FName& PinName : SubgraphOutputPins)
 		{
 			AddPin(PinName, EGPD_Output);
@@ -3,12 +3,17 @@
 #include "Nodes/GameFlowNode.h"
 #include "DiffResults.h"
 #include "GameFlowAsset.h"
+#include "GameFlowStats.h"
 #include "Config/GameFlowSettings.h"
+#include "Execution/GameFlowInstanceState.h"
 #include "Engine/StreamableManager.h"
 #include "Nodes/Pins/OutPinHandles.h"
+#include "UObject/UnrealType.h"
 
 UGameFlowNode::UGameFlowNode()
 {
+	ProgramIndex = INDEX_NONE;
+	
 #if WITH_EDITOR
 	TypeName = "Default";
 	bIsActive = false;
@@ -25,89 +30,45 @@ UGameFlowNode::UGameFlowNode()
 #include "AssetViewUtils.h"
 #include "EdGraph/EdGraphNode.h"
 
-TArray<FName> UGameFlowNode::GetInputPinsNames() const
-{
-	TArray<FName> InputPins;
-	Inputs.GenerateKeyArray(InputPins);
-	return InputPins;
-}
-
-TArray<FName> UGameFlowNode::GetOutputPinsNames() const
-{
-	TArray<FName> OutputPins;
-	Outputs.GenerateKeyArray(OutputPins);
-	return OutputPins;
-}
-
 FDiffResults UGameFlowNode::PinsDiff(const UGameFlowNode* OtherNode, TArray<FDiffSingleResult>& Diffs,
 	EEdGraphPinDirection Direction) const
 {
 	FDiffResults Results (&Diffs);
 
 	if (OtherNode == nullptr) return Results;
+
+	auto HasPin = [Direction](const UGameFlowNode* Node, FName PinName)
+	{
+		return Direction == EGPD_Input? Node->Inputs.Contains(PinName) : Node->Outputs.Contains(PinName);
+	};
+	auto AddPinDiff = [&](FName PinName, EDiffType::Category Category)
+	{
+		FDiffSingleResult PinDiff;
+		PinDiff.Diff = EDiffType::OBJECT_REQUEST_DIFF;
+		PinDiff.Category = Category;
+		PinDiff.Object1 = const_cast<UGameFlowNode*>(this);
+		PinDiff.Object2 = const_cast<UGameFlowNode*>(OtherNode);
+		PinDiff.DisplayString = FText::FromString(PinName.ToString());
+		Results.Add(PinDiff);
+	};
 	
-	if (Direction == EGPD_Input)
+	// Find all pins that the other node does not possess.
+	ForEachPin(Direction, [&](FName PinName, UPinHandle* PinHandle)
 	{
-		// Find all pins that the other node does not possess.
-		for (const FName PinName : GetInputPinsNames())
+		if (!HasPin(OtherNode, PinName))
 		{
-			if (!OtherNode->GetInputPinsNames().Contains(PinName))
-			{
-				FDiffSingleResult PinDiff;
-				PinDiff.Diff = EDiffType::OBJECT_REQUEST_DIFF;
-				PinDiff.Category = EDiffType::ADDITION;
-				PinDiff.Object1 = const_cast<UGameFlowNode*>(this);
-				PinDiff.Object2 = const_cast<UGameFlowNode*>(OtherNode);
-				PinDiff.DisplayString = FText::FromString(PinName.ToString());
-				Results.Add(PinDiff);
-			}
+			AddPinDiff(PinName, EDiffType::ADDITION);
 		}
+	});
 
-		// Find all pins that this node does not possess.
-		for (const FName PinName : OtherNode->GetInputPinsNames())
+	// Find all pins that this node does not possess.
+	OtherNode->ForEachPin(Direction, [&](FName PinName, UPinHandle* PinHandle)
+	{
+		if (!HasPin(this, PinName))
 		{
-			if (!GetInputPinsNames().Contains(PinName))
-			{
-				FDiffSingleResult PinDiff;
-				PinDiff.Diff = EDiffType::OBJECT_REQUEST_DIFF;
-				PinDiff.Category = EDiffType::SUBTRACTION;
-				PinDiff.Object1 = const_cast<UGameFlowNode*>(this);
-				PinDiff.Object2 = const_cast<UGameFlowNode*>(OtherNode);
-				PinDiff.DisplayString = FText::FromString(PinName.ToString());
-				Results.Add(PinDiff);
-			}
-		}	
-	}
-    else if (Direction == EGPD_Output)
-    {
-    	for (const FName PinName : GetOutputPinsNames())
-    	{
-    		if (!OtherNode->GetOutputPinsNames().Contains(PinName))
-    		{
-    			FDiffSingleResult PinDiff;
-    			PinDiff.Diff = EDiffType::OBJECT_REQUEST_DIFF;
-    			PinDiff.Category = EDiffType::ADDITION;
-    			PinDiff.Object1 = const_cast<UGameFlowNode*>(this);
-    			PinDiff.Object2 = const_cast<UGameFlowNode*>(OtherNode);
-    			PinDiff.DisplayString = FText::FromString(PinName.ToString());
-    			Results.Add(PinDiff);
-    		}
-    	}
-
-    	for (const FName PinName : OtherNode->GetOutputPinsNames())
-    	{
-    		if (!GetOutputPinsNames().Contains(PinName))
-    		{
-    			FDiffSingleResult PinDiff;
-    			PinDiff.Diff = EDiffType::OBJECT_REQUEST_DIFF;
-    			PinDiff.Category = EDiffType::SUBTRACTION;
-    			PinDiff.Object1 = const_cast<UGameFlowNode*>(this);
-    			PinDiff.Object2 = const_cast<UGameFlowNode*>(OtherNode);
-    			PinDiff.DisplayString = FText::FromString(PinName.ToString());
-    			Results.Add(PinDiff);
-    		}
-    	} 
-    }
+			AddPinDiff(PinName, EDiffType::SUBTRACTION);
+		}
+	});
 	return Results;
 }
 
@@ -134,8 +95,8 @@ bool UGameFlowNode::CanAddOutputPin() const
 
 bool UGameFlowNode::IsActiveNode() const
 {
-	const UGameFlowAsset* ParentAsset = GetTypedOuter<UGameFlowAsset>();
-	return ParentAsset->GetActiveNodes().Contains(this);
+	const UGameFlowAsset* ParentAsset = GetOwnerInstance();
+	return ParentAsset != nullptr && ParentAsset->GetActiveNodes().Contains(this);
 }
 
 void UGameFlowNode::AddPin(FName PinName, EEdGraphPinDirection PinDirection,
@@ -225,32 +186,36 @@ UPinHandle* UGameFlowNode::GetPinByName(FName PinName, TEnumAsByte<EEdGraphPinDi
 	return PinHandle;
 }
 
-TArray<UPinHandle*> UGameFlowNode::GetPinsByDirection(TEnumAsByte<EEdGraphPinDirection> Direction) const
+void UGameFlowNode::ForEachPin(TEnumAsByte<EEdGraphPinDirection> Direction, TFunctionRef<void(FName, UPinHandle*)> Visitor) const
 {
-	TArray<UPinHandle*> Pins;
-	
 	switch (Direction)
 	{
 	default: break;
 
 	case EGPD_Input:
+		for (const auto& [PinName, PinHandle] : Inputs)
 		{
-			TArray<UInputPinHandle*> InputPins;
-			Inputs.GenerateValueArray(InputPins);
-			Pins.Append(InputPins);
-			break;
+			Visitor(PinName, PinHandle);
 		}
+		break;
 
 	case EGPD_Output:
+		for (const auto& [PinName, PinHandle] : Outputs)
 		{
-			TArray<UOutPinHandle*> OutputPins;
-			Outputs.GenerateValueArray(OutputPins);
-			Pins.Append(OutputPins);
-			break;
+			Visitor(PinName, PinHandle);
 		}
+		break;
 	}
+}
 
-	return Pins;
+int32 UGameFlowNode::GetNumPins(TEnumAsByte<EEdGraphPinDirection> Direction) const
+{
+	switch (Direction)
+	{
+	default: return 0;
+	case EGPD_Input: return Inputs.Num();
+	case EGPD_Output: return Outputs.Num();
+	}
 }
 
 void UGameFlowNode::PostEditChangeChainProperty(struct FPropertyChangedChainEvent& PropertyChangedEvent)
@@ -373,15 +338,130 @@ TArray<FName> UGameFlowNode::GetNodeTypeOptions() const
 
 #endif
 
+UGameFlowAsset* UGameFlowNode::GetOwnerInstance() const
+{
+	// Shared nodes are owned by the source asset, the instance they're running for is the executing one.
+	UGameFlowAsset* CurrentInstance = FGameFlowInstanceScope::GetCurrent();
+	if(CurrentInstance != nullptr)
+	{
+		const FGameFlowProgram& Program = CurrentInstance->GetProgram();
+		if(Program.Nodes.IsValidIndex(ProgramIndex) && Program.Nodes[ProgramIndex].Node == this)
+		{
+			return CurrentInstance;
+		}
+	}
+	return GetTypedOuter<UGameFlowAsset>();
+}
+
+UWorld* UGameFlowNode::GetWorld() const
+{
+	// CDOs have no world, returning nullptr lets Blueprint editors know world context functions are allowed.
+	if(HasAnyFlags(RF_ClassDefaultObject)) return nullptr;
+	
+	const UGameFlowAsset* OwnerAsset = GetOwnerInstance();
+	return OwnerAsset != nullptr? OwnerAsset->GetWorld() : nullptr;
+}
+
+void UGameFlowNode::SerializeInstanceState(FArchive& Ar, void* State)
+{
+	UScriptStruct* StateStruct = GetInstanceStateStruct();
+	if(StateStruct != nullptr)
+	{
+		StateStruct->SerializeBin(Ar, State);
+	}
+}
+
+void UGameFlowNode::GetPrefetchAssets(TArray<FSoftObjectPath>& OutPaths) const
+{
+	// Walk containers and structs too, which is where nodes usually keep their asset lists.
+	for(TPropertyValueIterator<FProperty> It(GetClass(), this); It; ++It)
+	{
+		const FProperty* Property = It.Key();
+		FSoftObjectPath Path;
+		if(const FSoftObjectProperty* SoftObjectProperty = CastField<FSoftObjectProperty>(Property))
+		{
+			Path = SoftObjectProperty->GetPropertyValue(It.Value()).ToSoftObjectPath();
+		}
+		else if(const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			if(StructProperty->Struct != TBaseStructure<FSoftObjectPath>::Get()) continue;
+			
+			Path = *static_cast<const FSoftObjectPath*>(It.Value());
+			It.SkipRecursiveProperty();
+		}
+		
+		if(Path.IsValid())
+		{
+			OutPaths.AddUnique(Path);
+		}
+	}
+}
+
+void UGameFlowNode::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	
+	// Estimated totals already walk the subobjects, pins included.
+	if(CumulativeResourceSize.GetResourceSizeMode() != EResourceSizeMode::Exclusive) return;
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetClass()->GetStructureSize());
+#if WITH_EDITORONLY_DATA
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Inputs.GetAllocatedSize() + Outputs.GetAllocatedSize());
+	ForEachPin(EGPD_Input, [&CumulativeResourceSize](FName PinName, UPinHandle* PinHandle)
+	{
+		if(PinHandle != nullptr) PinHandle->GetResourceSizeEx(CumulativeResourceSize);
+	});
+	ForEachPin(EGPD_Output, [&CumulativeResourceSize](FName PinName, UPinHandle* PinHandle)
+	{
+		if(PinHandle != nullptr) PinHandle->GetResourceSizeEx(CumulativeResourceSize);
+	});
+#endif
+}
+
+void* UGameFlowNode::GetInstanceStateMemory() const
+{
+	const UGameFlowAsset* OwnerAsset = GetOwnerInstance();
+	return OwnerAsset != nullptr? OwnerAsset->GetNodeState(ProgramIndex) : nullptr;
+}
+
 void UGameFlowNode::TriggerOutputPin(FName PinName)
 {
-	UOutPinHandle* OutputPinHandle = Outputs.FindRef(PinName);
-	OutputPinHandle->TriggerPin();
+	UGameFlowAsset* OwnerAsset = GetOwnerInstance();
+	const int32 OutputPinIndex = OwnerAsset->GetProgram().FindOutputPin(ProgramIndex, PinName);
+	// Unknown or not compiled pins have nothing to trigger.
+	if(OutputPinIndex != INDEX_NONE)
+	{
+		OwnerAsset->TriggerOutputPin(OutputPinIndex);
+	}
+}
+
+void UGameFlowNode::TriggerOutputPinByIndex(int32 PinIndex)
+{
+	UGameFlowAsset* OwnerAsset = GetOwnerInstance();
+	const FGameFlowProgram& Program = OwnerAsset->GetProgram();
+	if(Program.Nodes.IsValidIndex(ProgramIndex))
+	{
+		const FGameFlowProgramNode& ProgramNode = Program.Nodes[ProgramIndex];
+		if(PinIndex >= 0 && PinIndex < ProgramNode.NumOutputs)
+		{
+			OwnerAsset->TriggerOutputPin(ProgramNode.FirstOutput + PinIndex);
+		}
+	}
+}
+
+void UGameFlowNode::TriggerOutputPinDeferred(FName PinName)
+{
+	UGameFlowAsset* OwnerAsset = GetOwnerInstance();
+	const int32 OutputPinIndex = OwnerAsset->GetProgram().FindOutputPin(ProgramIndex, PinName);
+	if(OutputPinIndex != INDEX_NONE)
+	{
+		OwnerAsset->DeferOutputPin(OutputPinIndex);
+	}
 }
 
 void UGameFlowNode::FinishExecute(bool bFinish)
 {
-	UGameFlowAsset* OwnerAsset = GetTypedOuter<UGameFlowAsset>();
+	UGameFlowAsset* OwnerAsset = GetOwnerInstance();
 	
 	// If the node has finished executing, remove it from asset active nodes.
 	if(bFinish && OwnerAsset != nullptr)
@@ -389,14 +469,17 @@ void UGameFlowNode::FinishExecute(bool bFinish)
 #if WITH_EDITOR
 		OwnerAsset->RemoveActiveNode(this);
 #endif
+		OwnerAsset->FinishNode(ProgramIndex);
 		OnFinishExecute();
 	}
 }
 
-void UGameFlowNode::TryExecute(FName PinName)
+void UGameFlowNode::TryExecute(FName PinName, int32 PinIndex)
 {
+	SCOPE_CYCLE_COUNTER(STAT_GameFlow_TryExecute);
+	INC_DWORD_STAT(STAT_GameFlow_NodesExecuted);
 #if WITH_EDITOR
-	UGameFlowAsset* OwnerAsset = GetTypedOuter<UGameFlowAsset>();
+	UGameFlowAsset* OwnerAsset = GetOwnerInstance();
 	// Mark this node as active.
 	OwnerAsset->AddActiveNode(this);
 
@@ -418,5 +501,13 @@ void UGameFlowNode::TryExecute(FName PinName)
 		}
 	}
 #endif
-	Execute(PinName);
+	// Blueprint nodes may override Execute, always dispatch them by name.
+	if(PinIndex != INDEX_NONE && !GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint))
+	{
+		ExecutePin(PinIndex, PinName);
+	}
+	else
+	{
+		Execute(PinName);
+	}
 }
\ No newline at end of file
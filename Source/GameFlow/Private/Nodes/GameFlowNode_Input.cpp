@@ -2,11 +2,13 @@
 
 #include "Nodes/GameFlowNode_Input.h"
 
+const TGameFlowPins<UGameFlowNode_Input::EOutputPin> UGameFlowNode_Input::OutputPins({ TEXT("Out") });
+
 UGameFlowNode_Input::UGameFlowNode_Input()
 {
 #if WITH_EDITOR
 	TypeName = "Input";
-	AddOutputPin_CDO("Out");
+	AddOutputPin_CDO(OutputPins[EOutputPin::Out]);
 #endif
 }
 
@@ -14,7 +16,7 @@ void UGameFlowNode_Input::Execute_Implementation(const FName PinName)
 {
 	Super::Execute_Implementation(PinName);
 
-	TriggerOutputPin("Out");
+	TriggerOutputPin(EOutputPin::Out);
 }
 
 
@@ -3,11 +3,13 @@
 #include "Nodes/GameFlowNode_Output.h"
 #include "GameFlowAsset.h"
 
+const TGameFlowPins<UGameFlowNode_Output::EInputPin> UGameFlowNode_Output::InputPins({ TEXT("Exec") });
+
 UGameFlowNode_Output::UGameFlowNode_Output()
 {
 #if WITH_EDITOR
 	TypeName = "Output";
-	AddInputPin_CDO("Exec");
+	AddInputPin_CDO(InputPins[EInputPin::Exec]);
 #endif
 }
 
@@ -15,7 +17,17 @@ void UGameFlowNode_Output::Execute_Implementation(const FName PinName)
 {
 	Super::Execute_Implementation(PinName);
     
+	UGameFlowAsset* GameFlowAsset = GetOwnerInstance();
+	// Let whoever is running the asset as a subgraph know which exit point has been reached.
+	if(GameFlowAsset->OnExitPoint.IsBound())
+	{
+		const FName* ExitPointName = GameFlowAsset->CustomOutputs.FindKey(this);
+		if(ExitPointName != nullptr)
+		{
+			GameFlowAsset->OnExitPoint.Broadcast(GameFlowAsset, *ExitPointName);
+		}
+	}
+	
 	// Terminate the execution of the parent game flow asset.
-	UGameFlowAsset* GameFlowAsset = CastChecked<UGameFlowAsset>(GetOuter());
 	GameFlowAsset->TerminateExecution();
 }
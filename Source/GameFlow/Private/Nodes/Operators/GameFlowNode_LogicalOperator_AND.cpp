@@ -1,22 +1,18 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Nodes/Operators//GameFlowNode_LogicalOperator_AND.h"
+#include "Execution/GameFlowProgram.h"
 #include "Kismet/KismetStringLibrary.h"
 
 UGameFlowNode_LogicalOperator_AND::UGameFlowNode_LogicalOperator_AND()
 {
-	// Initialize AND operator I/O default ports
-	ConditionalPorts.Add(false);
-	ConditionalPorts.Add(false);
-
-	ActiveInputs = 0;
-	
 #if WITH_EDITOR
 	// Initialize properties.
 	TypeName = "Conditional";
 	bCanAddInputPin = true;
-	
-	for(int i = 0; i < ConditionalPorts.Num(); i++)
+
+	// Initialize AND operator I/O default ports
+	for(int i = 0; i < 2; i++)
 	{
 		const int PortNumber = i + 1;
 		const FName PortName = FName(FString::FromInt(PortNumber));
@@ -39,19 +35,22 @@ void UGameFlowNode_LogicalOperator_AND::Execute_Implementation(const FName PinNa
 	// numerical input pin ports.
 	if(PinText.IsNumeric())
 	{
+		FGameFlowNode_LogicalOperator_AND_State* StatePtr = GetInstanceState<FGameFlowNode_LogicalOperator_AND_State>();
+		if(StatePtr == nullptr) return;
+		
+		FGameFlowNode_LogicalOperator_AND_State& State = *StatePtr;
 		const int32 PinIndex = UKismetStringLibrary::Conv_StringToInt(PinName.ToString()) - 1;
-		const bool bPortValue = ConditionalPorts[PinIndex];
 		// Is this port false (Has not been executed yet)?
-		if(!bPortValue)
+		if(State.ConditionalPorts.IsValidIndex(PinIndex) && !State.ConditionalPorts[PinIndex])
 		{
 			// Update node conditional ports state.
-			ConditionalPorts[PinIndex] = true;
-			ActiveInputs++;
+			State.ConditionalPorts[PinIndex] = true;
+			State.ActiveInputs++;
 		}
 		
-		if(ActiveInputs == ConditionalPorts.Num())
+		if(State.ActiveInputs == State.ConditionalPorts.Num())
 		{
-			Reset();
+			Reset(State);
 			TriggerOutputPin("Out");
 		}
 	}
@@ -66,12 +65,32 @@ void UGameFlowNode_LogicalOperator_AND::OnFinishExecute_Implementation()
 	TriggerOutputPin("Out");
 }
 
-void UGameFlowNode_LogicalOperator_AND::Reset()
+#if WITH_EDITOR
+
+FString UGameFlowNode_LogicalOperator_AND::GetCustomDebugInfo() const
+{
+	const FGameFlowNode_LogicalOperator_AND_State* State = GetInstanceState<FGameFlowNode_LogicalOperator_AND_State>();
+	if(State != nullptr)
+	{
+		return FString::Printf(TEXT("Active inputs: %d / %d \n"), State->ActiveInputs, State->ConditionalPorts.Num());
+	}
+	return "";
+}
+
+#endif
+
+void UGameFlowNode_LogicalOperator_AND::InitializeInstanceState(void* State, const FGameFlowProgramNode& ProgramNode) const
+{
+	// One port for each compiled input pin.
+	static_cast<FGameFlowNode_LogicalOperator_AND_State*>(State)->ConditionalPorts.Init(false, ProgramNode.NumInputs);
+}
+
+void UGameFlowNode_LogicalOperator_AND::Reset(FGameFlowNode_LogicalOperator_AND_State& State)
 {
 	// Reset node state after execution is ended. 
-	ActiveInputs = 0;
-	for (int i = 0; i < ConditionalPorts.Num(); i++)
+	State.ActiveInputs = 0;
+	for (int i = 0; i < State.ConditionalPorts.Num(); i++)
 	{
-		ConditionalPorts[i] = false;
+		State.ConditionalPorts[i] = false;
 	}
 }
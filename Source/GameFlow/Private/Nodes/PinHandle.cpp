@@ -15,32 +15,17 @@ UPinHandle::UPinHandle()
 void UPinHandle::TriggerPin()
 {
 #if WITH_EDITOR
-	// Have we hit an enabled breakpoint?
-	if (bIsBreakpointEnabled)
-	{
-		UGameFlowNode* Node = GetNodeOwner();
-		UGameFlowAsset* OwnerAsset = GetTypedOuter<UGameFlowAsset>();
-		// The template used to create the node owner of this pin instance.
-		UGameFlowNode* TemplateNode = OwnerAsset->TemplateAsset->GetNodeByGUID(Node->GUID);
-
-		// The template used to create this pin instance.
-		UPinHandle* TemplateHandle = TemplateNode->GetPinByName(PinName, EGPD_Input);
-		if (TemplateHandle == nullptr)
-		{
-			TemplateHandle = TemplateNode->GetPinByName(PinName, EGPD_Output);
-		}
-	
-		if (TemplateHandle->OnPinTriggered.IsBound())
-		{
-			TemplateHandle->OnPinTriggered.Broadcast(this);
-		}
-	}
+	NotifyTriggered();
 #endif
 }
 
-TArray<UPinHandle*> UPinHandle::GetConnections()
+void UPinHandle::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
 {
-	return Connections;
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	if(CumulativeResourceSize.GetResourceSizeMode() == EResourceSizeMode::Exclusive)
+	{
+		CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetClass()->GetStructureSize() + Connections.GetAllocatedSize());
+	}
 }
 
 UGameFlowNode* UPinHandle::GetNodeOwner() const
@@ -60,6 +45,36 @@ bool UPinHandle::HasConnections(const UPinHandle* OtherPinHandle) const
 
 #if WITH_EDITOR
 
+void UPinHandle::NotifyTriggered()
+{
+	// Have we hit an enabled breakpoint?
+	if (bIsBreakpointEnabled)
+	{
+		UGameFlowNode* Node = GetNodeOwner();
+		UGameFlowAsset* OwnerAsset = GetTypedOuter<UGameFlowAsset>();
+		
+		// Pins of nodes shared between instances are the template pins themselves.
+		UPinHandle* TemplateHandle = this;
+		if (!OwnerAsset->TemplateAsset.IsNull())
+		{
+			// The template used to create the node owner of this pin instance.
+			UGameFlowNode* TemplateNode = OwnerAsset->TemplateAsset->GetNodeByGUID(Node->GUID);
+
+			// The template used to create this pin instance.
+			TemplateHandle = TemplateNode->GetPinByName(PinName, EGPD_Input);
+			if (TemplateHandle == nullptr)
+			{
+				TemplateHandle = TemplateNode->GetPinByName(PinName, EGPD_Output);
+			}
+		}
+	
+		if (TemplateHandle->OnPinTriggered.IsBound())
+		{
+			TemplateHandle->OnPinTriggered.Broadcast(this);
+		}
+	}
+}
+
 void UPinHandle::CreateConnection(UPinHandle* OtherPinHandle)
 {
 	if(CanCreateConnection(OtherPinHandle))
@@ -86,10 +101,10 @@ void UPinHandle::CutConnection(UPinHandle* OtherPinHandle)
 
 void UPinHandle::CutAllConnections()
 {
-	for(const auto& Pin : GetConnections())
+	// Cutting a connection removes it from the array, start from the last one.
+	while(Connections.Num() > 0)
 	{
-        // After having found the connected pin, cut the connection.
-		CutConnection(Pin);
+		CutConnection(Connections.Last());
 	}
 }
 
@@ -2,6 +2,7 @@
 
 #include "Nodes/Pins/OutPinHandles.h"
 #include "Config/GameFlowSettings.h"
+#include "Nodes/GameFlowNode.h"
 #include "Nodes/Pins/InputPinHandle.h"
 
 UOutPinHandle::UOutPinHandle()
@@ -10,22 +11,22 @@ UOutPinHandle::UOutPinHandle()
 
 void UOutPinHandle::TriggerPin()
 {
-	Super::TriggerPin();
-	
-	// Trigger all connected exec pins.
-	for(const auto& Pin : GetConnections())
-	{
-		Pin->TriggerPin();
-	}
+	// Connected exec pins are triggered through the owner asset compiled program,
+	// which will also take care of notifying the editor debugger.
+	UGameFlowNode* Node = GetNodeOwner();
+	Node->TriggerOutputPin(PinName);
+}
 
 #if WITH_EDITOR
+
+void UOutPinHandle::NotifyTriggered()
+{
+	Super::NotifyTriggered();
+	
 	bIsActive = true;
 	ActivatedElapsedTime = UGameFlowSettings::Get()->WireHighlightDuration;
-#endif
 }
 
-#if WITH_EDITOR
-
 bool UOutPinHandle::CanCreateConnection(const UPinHandle* OtherPinHandle) const
 {
 	const bool bIsExecPin = OtherPinHandle->IsA(UInputPinHandle::StaticClass());
@@ -2,23 +2,30 @@
 
 #include "Nodes/Utils/GameFlowNode_Utils_Timer.h"
 
-#include "TimerManager.h"
+#include "GameFlowAsset.h"
+#include "GameFlowSubsystem.h"
+#include "Engine/GameInstance.h"
+
+const TGameFlowPins<UGameFlowNode_Utils_Timer::EInputPin> UGameFlowNode_Utils_Timer::InputPins(
+	{ TEXT("Start"), TEXT("Stop"), TEXT("Skip"), TEXT("Resume") });
+
+const TGameFlowPins<UGameFlowNode_Utils_Timer::EOutputPin> UGameFlowNode_Utils_Timer::OutputPins(
+	{ TEXT("Completed"), TEXT("Stopped"), TEXT("Step"), TEXT("Skipped") });
 
 UGameFlowNode_Utils_Timer::UGameFlowNode_Utils_Timer()
 {
 #if WITH_EDITOR
 	TypeName = "Latent";
 
-	AddInputPin_CDO("Start");
-	AddInputPin_CDO("Stop");
-	AddInputPin_CDO("Skip");
-	AddInputPin_CDO("Resume");
-
-	AddOutputPin_CDO("Completed");
-	AddOutputPin_CDO("Stopped");
-	AddOutputPin_CDO("Step");
-	AddOutputPin_CDO("Skipped");
+	for(const FName& PinName : InputPins.GetNames())
+	{
+		AddInputPin_CDO(PinName);
+	}
 
+	for(const FName& PinName : OutputPins.GetNames())
+	{
+		AddOutputPin_CDO(PinName);
+	}
 #endif
 	Time = 2.f;
 	StepTime = 0.f;
@@ -29,93 +36,147 @@ UGameFlowNode_Utils_Timer::UGameFlowNode_Utils_Timer()
 void UGameFlowNode_Utils_Timer::Execute_Implementation(const FName PinName)
 {
 	Super::Execute_Implementation(PinName);
-	
-	if(PinName.IsEqual("Start"))
+	ExecutePin(InputPins.IndexOf(PinName), PinName);
+}
+
+void UGameFlowNode_Utils_Timer::ExecutePin(int32 PinIndex, FName PinName)
+{
+	switch(static_cast<EInputPin>(PinIndex))
 	{
+	default: break;
+		
+	case EInputPin::Start:
 		StartTimer();
-	}
-	else if(PinName.IsEqual("Stop"))
-	{
+		break;
+
+	case EInputPin::Stop:
 		StopTimer();
-	}
-	else if(PinName.IsEqual("Skip"))
-	{
+		break;
+
+	case EInputPin::Skip:
 		SkipTimer();
-	}
-	else if(PinName.IsEqual("Resume"))
-	{
+		break;
+
+	case EInputPin::Resume:
 		ResumeTimer();
+		break;
 	}
 }
 
 void UGameFlowNode_Utils_Timer::StartTimer()
 {
-	GEngine->AddOnScreenDebugMessage(0, 3.f, FColor::Purple, FString::SanitizeFloat(GetWorld()->DeltaTimeSeconds));
-	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	if(TimingWheel == nullptr) return;
 	
-	TimerManager.SetTimer(CompletionTimerHandle, [this]()
-	{
-		TriggerOutputPin("Completed");
-	},Time, true);
+	FGameFlowNode_Utils_Timer_State* State = GetInstanceState<FGameFlowNode_Utils_Timer_State>();
+	UGameFlowAsset* Instance = GetOwnerInstance();
+
+	// Restarting the node replaces the timers of the previous run.
+	TimingWheel->ClearTimer(State->CompletionTimerHandle);
+	TimingWheel->ClearTimer(State->StepTimerHandle);
+	
+	State->CompletionTimerHandle = TimingWheel->SetTimer(Instance, this, static_cast<int32>(EOutputPin::Completed), Time, bLoop);
 
 	if(StepTime > 0.f)
 	{
-		TimerManager.SetTimer(StepTimerHandle, [this]()
-		{
-			TriggerOutputPin("Step");
-		}, StepTime, true);
+		State->StepTimerHandle = TimingWheel->SetTimer(Instance, this, static_cast<int32>(EOutputPin::Step), StepTime, true);
 	}
 }
 
 void UGameFlowNode_Utils_Timer::SkipTimer()
 {
-	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
-	
-	TimerManager.ClearTimer(CompletionTimerHandle);
-	TimerManager.ClearTimer(StepTimerHandle);
-	TriggerOutputPin("Skipped");
+	FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	if(TimingWheel != nullptr)
+	{
+		FGameFlowNode_Utils_Timer_State* State = GetInstanceState<FGameFlowNode_Utils_Timer_State>();
+		TimingWheel->ClearTimer(State->CompletionTimerHandle);
+		TimingWheel->ClearTimer(State->StepTimerHandle);
+	}
+	TriggerOutputPin(EOutputPin::Skipped);
+	FinishExecute(true);
 }
 
 void UGameFlowNode_Utils_Timer::ResumeTimer()
 {
-	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
-	
-	if(TimerManager.IsTimerPaused(CompletionTimerHandle))
+	FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	if(TimingWheel != nullptr)
 	{
-		TimerManager.UnPauseTimer(CompletionTimerHandle);
+		FGameFlowNode_Utils_Timer_State* State = GetInstanceState<FGameFlowNode_Utils_Timer_State>();
+		TimingWheel->UnPauseTimer(State->CompletionTimerHandle);
+		TimingWheel->UnPauseTimer(State->StepTimerHandle);
 	}
+	TriggerOutputPin(EOutputPin::Stopped);
+}
 
-	if(TimerManager.IsTimerPaused(StepTimerHandle))
+void UGameFlowNode_Utils_Timer::StopTimer()
+{
+	FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	if(TimingWheel != nullptr)
 	{
-		TimerManager.UnPauseTimer(StepTimerHandle);
+		FGameFlowNode_Utils_Timer_State* State = GetInstanceState<FGameFlowNode_Utils_Timer_State>();
+		TimingWheel->PauseTimer(State->CompletionTimerHandle);
+		TimingWheel->PauseTimer(State->StepTimerHandle);
 	}
-
-	TriggerOutputPin("Stopped");
 }
 
-void UGameFlowNode_Utils_Timer::StopTimer()
+void UGameFlowNode_Utils_Timer::OnTimerExpired(int32 Payload)
 {
-	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
-	if(TimerManager.IsTimerActive(CompletionTimerHandle))
+	const EOutputPin Pin = static_cast<EOutputPin>(Payload);
+	if(Pin == EOutputPin::Completed && !bLoop)
 	{
-		TimerManager.PauseTimer(CompletionTimerHandle);
+		// The timer is over, stop stepping.
+		FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+		if(TimingWheel != nullptr)
+		{
+			TimingWheel->ClearTimer(GetInstanceState<FGameFlowNode_Utils_Timer_State>()->StepTimerHandle);
+		}
+		TriggerOutputPin(Pin);
+		FinishExecute(true);
+		return;
 	}
+	TriggerOutputPin(Pin);
+}
 
-	if(TimerManager.IsTimerActive(StepTimerHandle))
+void UGameFlowNode_Utils_Timer::ReleaseInstanceState(void* State) const
+{
+	FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	if(TimingWheel != nullptr)
 	{
-		TimerManager.PauseTimer(StepTimerHandle);
+		FGameFlowNode_Utils_Timer_State* TimerState = static_cast<FGameFlowNode_Utils_Timer_State*>(State);
+		TimingWheel->ClearTimer(TimerState->CompletionTimerHandle);
+		TimingWheel->ClearTimer(TimerState->StepTimerHandle);
 	}
 }
 
+void UGameFlowNode_Utils_Timer::SerializeInstanceState(FArchive& Ar, void* State)
+{
+	FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	if(TimingWheel == nullptr) return;
+	
+	// Timers are written with the time they had left, and scheduled again when read back.
+	FGameFlowNode_Utils_Timer_State* TimerState = static_cast<FGameFlowNode_Utils_Timer_State*>(State);
+	UGameFlowAsset* Instance = GetOwnerInstance();
+	TimingWheel->SerializeTimer(Ar, TimerState->CompletionTimerHandle, Instance, this);
+	TimingWheel->SerializeTimer(Ar, TimerState->StepTimerHandle, Instance, this);
+}
+
+FGameFlowTimingWheel* UGameFlowNode_Utils_Timer::GetTimingWheel() const
+{
+	const UWorld* World = GetWorld();
+	const UGameInstance* GameInstance = World != nullptr? World->GetGameInstance() : nullptr;
+	UGameFlowSubsystem* Subsystem = GameInstance != nullptr? GameInstance->GetSubsystem<UGameFlowSubsystem>() : nullptr;
+	return Subsystem != nullptr? &Subsystem->GetTimingWheel() : nullptr;
+}
+
 #if WITH_EDITOR
 
 FString UGameFlowNode_Utils_Timer::GetCustomDebugInfo() const
 {
-	const UWorld* World =  GetWorld();
-	if(World != nullptr && CompletionTimerHandle.IsValid())
+	const FGameFlowTimingWheel* TimingWheel = GetTimingWheel();
+	const FGameFlowNode_Utils_Timer_State* State = GetInstanceState<FGameFlowNode_Utils_Timer_State>();
+	if(TimingWheel != nullptr && State != nullptr && State->CompletionTimerHandle.IsValid())
 	{
-		const FTimerManager& TimerManager = World->GetTimerManager();
-		return FString::Printf(TEXT("Elapsed time: %f \n"), TimerManager.GetTimerElapsed(CompletionTimerHandle));
+		return FString::Printf(TEXT("Elapsed time: %f \n"), TimingWheel->GetTimerElapsed(State->CompletionTimerHandle));
 	}
 	return "";
 }
@@ -4,20 +4,32 @@
 #include "GameFlow.h"
 #include "GameFlowSubsystem.h"
 #include "Engine/GameInstance.h"
+#include "GameFramework/Actor.h"
+
+const TGameFlowPins<UGameFlowNode_WorldListener::EInputPin> UGameFlowNode_WorldListener::InputPins(
+	{ TEXT("Start"), TEXT("Stop") });
+
+const TGameFlowPins<UGameFlowNode_WorldListener::EOutputPin> UGameFlowNode_WorldListener::OutputPins(
+	{ TEXT("Trigger Event"), TEXT("Completed"), TEXT("Stopped") });
 
 UGameFlowNode_WorldListener::UGameFlowNode_WorldListener()
 {
 #if WITH_EDITOR
 	TypeName = "Event";
-	
-	AddInputPin_CDO("Start");
-	AddInputPin_CDO("Stop");
-	
-	AddOutputPin_CDO("Trigger Event");
-	AddOutputPin_CDO("Completed");
-	AddOutputPin_CDO("Stopped");
+
+	for(const FName& PinName : InputPins.GetNames())
+	{
+		AddInputPin_CDO(PinName);
+	}
+
+	for(const FName& PinName : OutputPins.GetNames())
+	{
+		AddOutputPin_CDO(PinName);
+	}
 #endif
 	
+	ListeningRadius = 0.f;
+	ListeningCenter = FVector::ZeroVector;
 	Limit = 0;
 	Count = 0;
 }
@@ -25,14 +37,22 @@ UGameFlowNode_WorldListener::UGameFlowNode_WorldListener()
 void UGameFlowNode_WorldListener::Execute_Implementation(const FName PinName)
 {
 	Super::Execute_Implementation(PinName);
-	
-	if(PinName.IsEqual("Start"))
+	ExecutePin(InputPins.IndexOf(PinName), PinName);
+}
+
+void UGameFlowNode_WorldListener::ExecutePin(int32 PinIndex, FName PinName)
+{
+	switch(static_cast<EInputPin>(PinIndex))
 	{
+	default: break;
+
+	case EInputPin::Start:
 		StartListening();
-	}
-	else if(PinName.IsEqual("Stop"))
-	{
+		break;
+
+	case EInputPin::Stop:
 		StopListening();
+		break;
 	}
 }
 
@@ -52,17 +72,17 @@ void UGameFlowNode_WorldListener::OnFinishExecute_Implementation()
 	UGameFlowSubsystem* GameFlowSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
     
 	// Stop listening to game flow subsystem events.
-	GameFlowSubsystem->OnListenerComponentRegistered.RemoveAll(this);
-	GameFlowSubsystem->OnListenerComponentUnregistered.RemoveAll(this);
-	GameFlowSubsystem->OnGameplayTagAdded.RemoveAll(this);
-	GameFlowSubsystem->OnGameplayTagRemoved.RemoveAll(this);
+	GameFlowSubsystem->UnsubscribeFromListenerEvents(ListenerEventsHandle);
 
-	TArray<UGameFlowListener*> NodeListeners = GameFlowSubsystem->GetListenersByGameplayTags(ListenerTags, MatchingStrategy);
-	// Stop listening to all matching actor component listeners.
-	for(UGameFlowListener* Listener : NodeListeners)
+	// Stop listening to exactly the components this node has been listening to, wherever they are now.
+	for(const TWeakObjectPtr<UGameFlowListener>& Listener : ListenedComponents)
 	{
-		StopListeningToComponent(Listener);
+		if(Listener.IsValid())
+		{
+			StopListeningToComponent(Listener.Get());
+		}
 	}
+	ListenedComponents.Reset();
 	
 	// Reset counter to 0.
 	Count = 0;
@@ -71,36 +91,42 @@ void UGameFlowNode_WorldListener::OnFinishExecute_Implementation()
 void UGameFlowNode_WorldListener::StartListening()
 {
 	UGameFlowSubsystem* GameFlowSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
-	TArray<UGameFlowListener*> NodeListeners = GameFlowSubsystem->GetListenersByGameplayTags(ListenerTags, MatchingStrategy);
+	TArray<UGameFlowListener*> NodeListeners;
+	QueryNodeListeners(GameFlowSubsystem, NodeListeners);
+	IdentityMask = FGameFlowTagMask::Make(IdentityTags, true);
+	ExactIdentityMask = FGameFlowTagMask::Make(IdentityTags, false);
 
-	// Listen to subsystem events relative to component listeners.
-	GameFlowSubsystem->OnListenerComponentRegistered.AddDynamic(this, &UGameFlowNode_WorldListener::OnComponentRegistered);
-	GameFlowSubsystem->OnListenerComponentUnregistered.AddDynamic(this, &UGameFlowNode_WorldListener::OnComponentUnregistered);
-	GameFlowSubsystem->OnGameplayTagAdded.AddDynamic(this, &UGameFlowNode_WorldListener::OnComponentGameplayTagAdded);
-	GameFlowSubsystem->OnGameplayTagRemoved.AddDynamic(this, &UGameFlowNode_WorldListener::OnComponentGameplayTagRemoved);
+	// Listen to subsystem events relative to component listeners, only for the tags this node cares about.
+	if(!ListenerEventsHandle.IsValid())
+	{
+		FGameplayTagContainer RoutedTags = IdentityTags;
+		RoutedTags.AppendTags(ListenerTags);
+		ListenerEventsHandle = GameFlowSubsystem->SubscribeToListenerEvents(RoutedTags,
+			FOnGameFlowListenerEvent::CreateUObject(this, &UGameFlowNode_WorldListener::HandleListenerEvent));
+	}
 	
 	// Listen to all components matching identity tag of this node.
 	for(UGameFlowListener* Listener : NodeListeners)
 	{
-		ListenToComponent(Listener);
+		AddListenedComponent(Listener);
 	}
 }
 
 void UGameFlowNode_WorldListener::StopListening()
 {
 	FinishExecute(true);
-	TriggerOutputPin("Stopped");
+	TriggerOutputPin(EOutputPin::Stopped);
 }
 
 void UGameFlowNode_WorldListener::OnTriggerEvent_Implementation()
 {
-	TriggerOutputPin("Trigger Event");
+	TriggerOutputPin(EOutputPin::TriggerEvent);
 }
 
 void UGameFlowNode_WorldListener::OnCompleted_Implementation()
 {
 	FinishExecute(true);
-	TriggerOutputPin("Completed");
+	TriggerOutputPin(EOutputPin::Completed);
 }
 
 void UGameFlowNode_WorldListener::ListenToComponent_Implementation(UGameFlowListener* ListenerComponent)
@@ -127,7 +153,7 @@ void UGameFlowNode_WorldListener::OnComponentGameplayTagAdded_Implementation(UGa
    FGameplayTag AddedTag)
 {
 	// We only care if the tag which was added is part of the identity of this node.
-	if(IdentityTags.HasTag(AddedTag))
+	if(IdentityMask.IsValid()? IdentityMask.HasTag(AddedTag) : IdentityTags.HasTag(AddedTag))
 	{
 		UpdateComponentListener(ListenerComponent);
 	}
@@ -137,21 +163,108 @@ void UGameFlowNode_WorldListener::OnComponentGameplayTagRemoved_Implementation(U
 	FGameplayTag RemovedTag)
 {
 	// We only care if the tag which was removed is part of the identity of this node.
-	if(IdentityTags.HasTag(RemovedTag))
+	if(IdentityMask.IsValid()? IdentityMask.HasTag(RemovedTag) : IdentityTags.HasTag(RemovedTag))
 	{
 		UpdateComponentListener(ListenerComponent);
 	}
 }
 
+void UGameFlowNode_WorldListener::HandleListenerEvent(EGameFlowListenerEvent Event,
+	UGameFlowListener* ListenerComponent, FGameplayTag Tag)
+{
+	switch(Event)
+	{
+	case EGameFlowListenerEvent::Registered:
+		if(IsInListeningRadius(ListenerComponent))
+		{
+			OnComponentRegistered(ListenerComponent);
+		}
+		break;
+
+	case EGameFlowListenerEvent::Unregistered:
+		{
+			const bool bWasListened = RemoveListenedComponent(ListenerComponent);
+			if(bWasListened || IsInListeningRadius(ListenerComponent))
+			{
+				OnComponentUnregistered(ListenerComponent);
+			}
+		}
+		break;
+
+	case EGameFlowListenerEvent::TagAdded:
+		if(IsInListeningRadius(ListenerComponent))
+		{
+			OnComponentGameplayTagAdded(ListenerComponent, Tag);
+		}
+		break;
+
+	case EGameFlowListenerEvent::TagRemoved:
+		OnComponentGameplayTagRemoved(ListenerComponent, Tag);
+		break;
+	}
+}
+
 void UGameFlowNode_WorldListener::UpdateComponentListener(UGameFlowListener* ListenerComponent)
 {
-	if(DoGameplayTagsMatch(ListenerComponent->IdentityTags))
+	if(DoListenerTagsMatch(ListenerComponent) && IsInListeningRadius(ListenerComponent))
+	{
+		AddListenedComponent(ListenerComponent);
+	}
+	else
+	{
+		RemoveListenedComponent(ListenerComponent);
+	}
+}
+
+void UGameFlowNode_WorldListener::AddListenedComponent(UGameFlowListener* ListenerComponent)
+{
+	const int32 NumListened = ListenedComponents.Num();
+	if(ListenedComponents.AddUnique(ListenerComponent) == NumListened)
 	{
 		ListenToComponent(ListenerComponent);
 	}
+}
+
+bool UGameFlowNode_WorldListener::RemoveListenedComponent(UGameFlowListener* ListenerComponent)
+{
+	if(ListenedComponents.RemoveSwap(ListenerComponent) == 0) return false;
+
+	StopListeningToComponent(ListenerComponent);
+	return true;
+}
+
+bool UGameFlowNode_WorldListener::IsInListeningRadius(const UGameFlowListener* ListenerComponent) const
+{
+	if(ListeningRadius <= 0.f) return true;
+
+	// Same test as UGameFlowSubsystem::QueryListenersInRadius, on the owner location.
+	const AActor* Owner = ListenerComponent->GetOwner();
+	return Owner != nullptr && FVector::DistSquared(ListeningCenter, Owner->GetActorLocation()) <= FMath::Square(ListeningRadius);
+}
+
+bool UGameFlowNode_WorldListener::DoListenerTagsMatch(const UGameFlowListener* ListenerComponent)
+{
+	const FGameFlowTagMask& OtherMask = ListenerComponent->GetExactIdentityMask();
+	if(!ExactIdentityMask.IsValid() || !OtherMask.IsValid())
+	{
+		return DoGameplayTagsMatch(ListenerComponent->IdentityTags);
+	}
+	
+	return MatchingStrategy == EGameplayContainerMatchType::All?
+		ExactIdentityMask.HasAll(OtherMask)
+		: ExactIdentityMask.HasAny(OtherMask);
+}
+
+void UGameFlowNode_WorldListener::QueryNodeListeners(const UGameFlowSubsystem* GameFlowSubsystem,
+	TArray<UGameFlowListener*>& OutListeners) const
+{
+	if(ListeningRadius > 0.f)
+	{
+		GameFlowSubsystem->QueryListenersInRadius(ListenerTags, MatchingStrategy, ListeningCenter, ListeningRadius, OutListeners);
+	}
 	else
 	{
-		StopListeningToComponent(ListenerComponent);
+		GameFlowSubsystem->QueryListeners(ListenerTags, MatchingStrategy, OutListeners);
 	}
 }
 
@@ -4,14 +4,22 @@
 #include "GameFlowSubsystem.h"
 #include "Engine/GameInstance.h"
 
+const TGameFlowPins<UGameFlowNode_WorldListener_NotifyListeners::EInputPin> UGameFlowNode_WorldListener_NotifyListeners::InputPins(
+	{ TEXT("Exec") });
+
+const TGameFlowPins<UGameFlowNode_WorldListener_NotifyListeners::EOutputPin> UGameFlowNode_WorldListener_NotifyListeners::OutputPins(
+	{ TEXT("Out") });
+
 UGameFlowNode_WorldListener_NotifyListeners::UGameFlowNode_WorldListener_NotifyListeners()
 {
 #if WITH_EDITOR
 	TypeName = "Event";
 
-	AddInputPin_CDO("Exec");
-	AddOutputPin_CDO("Out");
+	AddInputPin_CDO(InputPins[EInputPin::Exec]);
+	AddOutputPin_CDO(OutputPins[EOutputPin::Out]);
 #endif
+	NotificationRadius = 0.f;
+	NotificationCenter = FVector::ZeroVector;
 }
 
 void UGameFlowNode_WorldListener_NotifyListeners::Execute_Implementation(const FName PinName)
@@ -20,7 +28,14 @@ void UGameFlowNode_WorldListener_NotifyListeners::Execute_Implementation(const F
 
 	UGameFlowSubsystem* GameFlowSubsystem = GetWorld()->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
 	// Send event notification to all component listener with matching tags and strategy.
-	GameFlowSubsystem->NotifyListeners(IdentityTags, MatchingStrategy);
+	if(NotificationRadius > 0.f)
+	{
+		GameFlowSubsystem->NotifyListenersInRadius(IdentityTags, MatchingStrategy, NotificationCenter, NotificationRadius);
+	}
+	else
+	{
+		GameFlowSubsystem->NotifyListeners(IdentityTags, MatchingStrategy);
+	}
 
 	FinishExecute(true);
 }
@@ -30,5 +45,5 @@ void UGameFlowNode_WorldListener_NotifyListeners::OnFinishExecute_Implementation
 	Super::OnFinishExecute_Implementation();
 
 	// Execute default output pin.
-	TriggerOutputPin("Out");
+	TriggerOutputPin(EOutputPin::Out);
 }
@@ -0,0 +1,178 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "GameFlowAsset.h"
+#include "GameFlowListener.h"
+#include "GameFlowListenerIndex.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/AutomationTest.h"
+#include "Nodes/GameFlowNode_Input.h"
+#include "Nodes/PinHandle.h"
+#include "Nodes/Flow/GameFlowNode_FlowControl_Sequence.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+namespace GameFlowAllocationTests
+{
+	/** Forwards every call to the engine allocator, counting the allocations made by the game thread. */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		FMalloc* Inner = nullptr;
+		int32 NumAllocations = 0;
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Count_GameThread();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Count_GameThread();
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("GameFlowCountingMalloc");
+		}
+
+	private:
+		FORCEINLINE void Count_GameThread()
+		{
+			if (IsInGameThread())
+			{
+				++NumAllocations;
+			}
+		}
+	};
+
+	/** Routes GMalloc through the counting allocator while in scope. */
+	struct FScopedAllocationCounter
+	{
+		FScopedAllocationCounter()
+		{
+			// Kept alive for the whole run, other threads may still be inside it after the scope ends.
+			static FCountingMalloc CountingMalloc;
+			Counter = &CountingMalloc;
+			Counter->Inner = GMalloc;
+			Counter->NumAllocations = 0;
+			GMalloc = Counter;
+		}
+
+		~FScopedAllocationCounter()
+		{
+			GMalloc = Counter->Inner;
+		}
+
+		FORCEINLINE int32 GetNumAllocations() const { return Counter->NumAllocations; }
+
+	private:
+		FCountingMalloc* Counter;
+	};
+
+	/** Number of repetitions measured for each hot path. */
+	constexpr int32 NumIterations = 64;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameFlowHotPathAllocationTest, "GameFlow.Execution.HotPathAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FGameFlowHotPathAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace GameFlowAllocationTests;
+
+	// Start -> Sequence, executed outside of a world so that pins are triggered right away.
+	UGameFlowAsset* Asset = NewObject<UGameFlowAsset>(GetTransientPackage(), NAME_None, RF_Transient);
+	UGameFlowNode_Input* InputNode = NewObject<UGameFlowNode_Input>(Asset);
+	InputNode->GUID = FGuid::NewGuid();
+	Asset->AddNode(InputNode);
+	Asset->CustomInputs.Add("Start", InputNode);
+
+	UGameFlowNode_FlowControl_Sequence* SequenceNode = NewObject<UGameFlowNode_FlowControl_Sequence>(Asset);
+	SequenceNode->GUID = FGuid::NewGuid();
+	Asset->AddNode(SequenceNode);
+
+	UPinHandle* StartPin = InputNode->GetPinByName("Out", EGPD_Output);
+	UPinHandle* ExecPin = SequenceNode->GetPinByName("Exec", EGPD_Input);
+	if (!TestNotNull(TEXT("Start pin"), StartPin) || !TestNotNull(TEXT("Exec pin"), ExecPin))
+	{
+		return false;
+	}
+	StartPin->CreateConnection(ExecPin);
+
+	// Warm up: compiles the program, allocates the instance state and grows the work queue.
+	Asset->Execute("Start");
+	const int32 StartPinIndex = Asset->GetProgram().FindOutputPin(InputNode->GetNodeId(), "Out");
+	if (!TestNotEqual(TEXT("Start pin index"), StartPinIndex, int32(INDEX_NONE)))
+	{
+		return false;
+	}
+	Asset->TriggerOutputPin(StartPinIndex);
+
+	{
+		FScopedAllocationCounter AllocationCounter;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Asset->TriggerOutputPin(StartPinIndex);
+		}
+		TestEqual(TEXT("Allocations triggering output pins"), AllocationCounter.GetNumAllocations(), 0);
+	}
+
+	{
+		FScopedAllocationCounter AllocationCounter;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Asset->Execute("Start");
+		}
+		TestEqual(TEXT("Allocations executing entry points"), AllocationCounter.GetNumAllocations(), 0);
+	}
+
+	// Listener queries reuse the dispatch array, the same way UGameFlowSubsystem::DispatchNotification does.
+	FGameFlowListenerIndex ListenerIndex;
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		ListenerIndex.AddListener(NewObject<UGameFlowListener>(GetTransientPackage()));
+	}
+	TArray<UGameFlowListener*> QueriedListeners;
+	const FGameplayTagContainer EmptyTags;
+	ListenerIndex.Query(EmptyTags, EGameplayContainerMatchType::All, QueriedListeners);
+	TestEqual(TEXT("Queried listeners"), QueriedListeners.Num(), 8);
+
+	{
+		FScopedAllocationCounter AllocationCounter;
+		for (int32 Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			QueriedListeners.Reset();
+			ListenerIndex.Query(EmptyTags, EGameplayContainerMatchType::All, QueriedListeners);
+		}
+		TestEqual(TEXT("Allocations querying listeners"), AllocationCounter.GetNumAllocations(), 0);
+	}
+
+	Asset->ResetInstance();
+	Asset->MarkAsGarbage();
+	return true;
+}
+
+#endif
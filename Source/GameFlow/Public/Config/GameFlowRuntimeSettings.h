@@ -0,0 +1,82 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "GameFlowRuntimeSettings.generated.h"
+
+/**
+ * Game Flow runtime configuration, shipped with the game.
+ */
+UCLASS(Config=Game, DefaultConfig, meta=(DisplayName="Game Flow Runtime"))
+class GAMEFLOW_API UGameFlowRuntimeSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UGameFlowRuntimeSettings();
+	
+	/**
+	 * Maximum game thread time, in milliseconds, game flow instances can spend executing nodes each frame.
+	 * Work exceeding the budget is carried over to the next frames. 0 means unlimited.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Scheduler", meta=(ClampMin=0, Units="Milliseconds"))
+	float FrameBudgetMs;
+
+	/**
+	 * Duration of a game flow timing wheel tick, in milliseconds. Node timers expire
+	 * on tick boundaries, lower values are more precise but cost more to advance.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Timers", meta=(ClampMin=1, Units="Milliseconds"))
+	float TimerResolutionMs;
+
+	/**
+	 * If true, listener notifications are buffered and identical notifications sent during the
+	 * same frame are dispatched once, at the beginning of the next game flow subsystem tick.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Events")
+	bool bCoalesceListenerEvents;
+
+	/** Maximum number of distinct listener notifications buffered per frame. Overflowing ones are dispatched right away. */
+	UPROPERTY(Config, EditAnywhere, Category="Events", meta=(ClampMin=1, EditCondition="bCoalesceListenerEvents"))
+	int32 EventBusCapacity;
+
+	/**
+	 * If true, the game flow subsystem keeps listeners inside a spatial hash grid, updated as their
+	 * owners move, so that area-limited listener queries only visit the listeners nearby.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Events")
+	bool bEnableSpatialListenerQueries;
+
+	/** Edge length of the listeners spatial hash grid cells. Should be close to the typical query radius. */
+	UPROPERTY(Config, EditAnywhere, Category="Events", meta=(ClampMin=1, Units="Centimeters", EditCondition="bEnableSpatialListenerQueries"))
+	float ListenerGridCellSize;
+
+	/**
+	 * When subgraph assets start loading. -1 loads them as soon as the owner instance is created,
+	 * 0 when execution reaches the subgraph node, N when execution gets within N connections of it.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Subgraphs", meta=(ClampMin=-1))
+	int32 SubgraphPreloadHops;
+
+	/**
+	 * If true, subgraphs statically referenced by a game flow asset are flattened into its program when
+	 * cooking, so that entering and leaving them has no runtime cost. Inlined subgraphs share the state
+	 * of the parent instance, and their exit points do not finish the execution of the parent asset.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Subgraphs")
+	bool bInlineSubgraphsOnCook;
+
+	/**
+	 * Soft assets referenced by the nodes within this number of connections of an active node are loaded
+	 * asynchronously, and released once execution takes another branch. 0 disables prefetching.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Assets", meta=(ClampMin=0))
+	int32 AssetPrefetchHops;
+
+	FORCEINLINE static const UGameFlowRuntimeSettings* Get()
+	{
+		return GetDefault<UGameFlowRuntimeSettings>();
+	}
+};
@@ -0,0 +1,95 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** The snapshot of a single game flow instance inside an autosave. */
+struct GAMEFLOW_API FGameFlowSavedInstance
+{
+	/** The asset the instance has been created from. */
+	FSoftObjectPath Asset;
+
+	/** Snapshot written by UGameFlowAsset::SaveSnapshot(). */
+	TArray<uint8> Snapshot;
+};
+
+/** The instances written by an autosave, keyed by instance. */
+using FGameFlowSavedInstances = TMap<uint64, FGameFlowSavedInstance>;
+
+/**
+ * An encoded game flow autosave, ready to be written to disk. Autosaves only hold the instances
+ * which changed since the previous autosave, and the instances which stopped running since then.
+ */
+struct GAMEFLOW_API FGameFlowAutosave
+{
+	/** Sequence number of this autosave, starting from 1. */
+	uint32 Sequence = 0;
+
+	/** Sequence number of the autosave this one should be applied on, 0 if this autosave holds all the instances. */
+	uint32 BaseSequence = 0;
+
+	/** The number of instances written inside this autosave. */
+	int32 NumChangedInstances = 0;
+
+	/** Compressed autosave. */
+	TArray<uint8> Data;
+
+	/** Does this autosave hold all the running instances? */
+	FORCEINLINE bool IsFull() const { return BaseSequence == 0; }
+
+	/**
+	 * Apply an encoded autosave on the instances of its base autosave.
+	 * @param Data An encoded autosave.
+	 * @param InOutInstances The instances of the base autosave, replaced by the instances of the decoded one.
+	 * @param InOutSequence Sequence number of the base autosave, replaced by the one of the decoded autosave.
+	 * @return False if the data is malformed, or should be applied on another autosave.
+	 */
+	static bool Decode(const TArray<uint8>& Data, FGameFlowSavedInstances& InOutInstances, uint32& InOutSequence);
+};
+
+DECLARE_DELEGATE_OneParam(FOnGameFlowAutosaved, const FGameFlowAutosave&);
+
+/**
+ * Encodes and compresses game flow autosaves on a background task. The game thread only pays for the
+ * snapshots of the instances which changed since the previous autosave, each autosave being a delta
+ * against the previous one.
+ */
+class GAMEFLOW_API FGameFlowAutosaver
+{
+public:
+	FGameFlowAutosaver();
+
+	/**
+	 * Start encoding an autosave. Should be called on the game thread, while no instance is executing.
+	 * @param ChangedInstances Snapshots of the instances which changed since the previous autosave, or of all the running instances.
+	 * @param RunningInstances Keys of all the running instances, instances missing from it are removed from the autosave.
+	 * @param bFull If true, the autosave will not depend on the previous ones.
+	 * @param OnComplete Called on the game thread once the autosave has been encoded.
+	 */
+	void Encode(TArray<TPair<uint64, FGameFlowSavedInstance>>&& ChangedInstances, TSet<uint64>&& RunningInstances,
+		bool bFull, FOnGameFlowAutosaved OnComplete);
+
+	/** Is an autosave being encoded? Autosaves are encoded one at a time. */
+	bool IsEncoding() const;
+
+	/** Has an autosave been encoded since the last reset? If not, the next autosave should be full. */
+	FORCEINLINE bool HasPreviousAutosave() const { return bHasPreviousAutosave; }
+
+	/** Forget the previous autosaves, the next one will hold all the running instances. */
+	void Reset();
+
+private:
+	struct FState
+	{
+		/** The instances written by the previous autosaves, base of the next delta. Only touched by the encoding task while it runs. */
+		FGameFlowSavedInstances Instances;
+		uint32 Sequence = 0;
+		TAtomic<bool> bIsEncoding { false };
+	};
+
+	/** Shared with the encoding task, so that it can complete after the autosaver has been destroyed. */
+	TSharedRef<FState, ESPMode::ThreadSafe> State;
+
+	bool bHasPreviousAutosave = false;
+};
@@ -0,0 +1,55 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFlowInstanceHandle.generated.h"
+
+/**
+ * Lightweight reference to a game flow asset instance running inside the game flow subsystem.
+ * Handles are generational indices: once the instance finishes, its slot can be reused by
+ * another instance, and all the handles to the finished instance become stale.
+ */
+USTRUCT(BlueprintType)
+struct GAMEFLOW_API FGameFlowInstanceHandle
+{
+	GENERATED_BODY()
+
+	FGameFlowInstanceHandle() = default;
+	
+	FGameFlowInstanceHandle(int32 InIndex, uint32 InGeneration)
+		: Index(InIndex), Generation(InGeneration)
+	{
+	}
+
+	/** Has this handle ever been assigned to an instance? Does not mean the instance is still running. */
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+
+	/** Index of the instance slot inside the subsystem. */
+	FORCEINLINE int32 GetIndex() const { return Index; }
+
+	/** Generation of the instance slot at the time the handle was created. */
+	FORCEINLINE uint32 GetGeneration() const { return Generation; }
+
+	FORCEINLINE bool operator==(const FGameFlowInstanceHandle& Other) const
+	{
+		return Index == Other.Index && Generation == Other.Generation;
+	}
+
+	FORCEINLINE bool operator!=(const FGameFlowInstanceHandle& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	friend FORCEINLINE uint32 GetTypeHash(const FGameFlowInstanceHandle& Handle)
+	{
+		return HashCombine(GetTypeHash(Handle.Index), GetTypeHash(Handle.Generation));
+	}
+
+private:
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+
+	UPROPERTY()
+	uint32 Generation = 0;
+};
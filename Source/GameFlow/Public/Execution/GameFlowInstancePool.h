@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFlowInstancePool.generated.h"
+
+class UGameFlowAsset;
+
+/**
+ * Pool of ready-to-run instances of a single game flow asset.
+ * Instances are either created ahead of time (prewarmed) or recycled
+ * once finished, so that executing the asset does not allocate.
+ */
+USTRUCT()
+struct GAMEFLOW_API FGameFlowInstancePool
+{
+	GENERATED_BODY()
+
+	/** The asset instanced by this pool. */
+	UPROPERTY()
+	TObjectPtr<UGameFlowAsset> Asset = nullptr;
+
+private:
+	/** Instances waiting to be executed. */
+	UPROPERTY()
+	TArray<TObjectPtr<UGameFlowAsset>> FreeInstances;
+
+public:
+	/**
+	 * Get a ready-to-run instance of the pooled asset, creating it if the pool is empty.
+	 * @param Outer The object which will own newly created instances.
+	 */
+	UGameFlowAsset* Acquire(UObject* Outer);
+
+	/**
+	 * Give an instance back to the pool. Instances sharing the graph with the pooled
+	 * asset are reset and kept for reuse, as long as the pool is not full.
+	 * @return True if the instance has been kept, false if it has been left to the garbage collector.
+	 */
+	bool Release(UGameFlowAsset* Instance);
+
+	/**
+	 * Make sure the pool holds at least the given number of free instances.
+	 * @param Outer The object which will own newly created instances.
+	 * @param Count The number of free instances.
+	 */
+	void Prewarm(UObject* Outer, int32 Count);
+
+	/** The number of instances waiting to be executed. */
+	FORCEINLINE int32 NumFree() const { return FreeInstances.Num(); }
+
+	/** Get the instances waiting to be executed, without copying them. */
+	FORCEINLINE TConstArrayView<TObjectPtr<UGameFlowAsset>> GetFreeInstances() const { return FreeInstances; }
+
+private:
+	/** Create a new instance of the pooled asset, as opposed to reusing a free one. */
+	UGameFlowAsset* CreateInstance(UObject* Outer) const;
+};
@@ -0,0 +1,86 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UGameFlowAsset;
+struct FGameFlowProgram;
+
+/**
+ * Compact block holding the per-instance mutable state of all the nodes of a
+ * game flow asset instance. Each stateful node owns one struct inside the block,
+ * at the offset computed by the program state layout. The block keeps a copy of the
+ * layout it has been allocated with, as the program may be recompiled while it is alive.
+ * @remark State structs should not hold strong references to objects, use weak pointers instead.
+ */
+class GAMEFLOW_API FGameFlowInstanceState
+{
+public:
+	FGameFlowInstanceState() = default;
+	FGameFlowInstanceState(const FGameFlowInstanceState&) = delete;
+	FGameFlowInstanceState& operator=(const FGameFlowInstanceState&) = delete;
+	~FGameFlowInstanceState() { Release(); }
+
+	/**
+	 * Allocate and initialize the state of all program nodes.
+	 * @param InProgram The program describing the state layout. Should outlive this state block.
+	 */
+	void Initialize(const FGameFlowProgram& InProgram);
+
+	/** Destroy all nodes state and free the block. */
+	void Release();
+
+	/** Bring all nodes state back to its initial value, reusing the allocated block if the program layout did not change. */
+	void Reset();
+
+	/** Is this state block allocated? */
+	FORCEINLINE bool IsInitialized() const { return Program != nullptr; }
+
+	/** Has the program been recompiled with a different state layout since this block has been allocated? */
+	bool IsStale() const;
+
+	/**
+	 * Get the state of a node.
+	 * @param NodeIndex Index of the node inside the program nodes table.
+	 * @return The node state struct, nullptr if the node is stateless or the block is stale.
+	 */
+	void* GetNodeState(int32 NodeIndex) const;
+
+	/** The size in bytes of the allocated state block and of its layout. */
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return (Memory != nullptr? Size : 0) + Slots.GetAllocatedSize(); }
+
+private:
+	/** Where a node state lives inside the block, as laid out when the block has been allocated. */
+	struct FNodeStateSlot
+	{
+		int32 Offset = INDEX_NONE;
+		const UScriptStruct* Struct = nullptr;
+	};
+
+	const FGameFlowProgram* Program = nullptr;
+	uint8* Memory = nullptr;
+	int32 Size = 0;
+	uint32 LayoutHash = 0;
+	/** The layout of the block, indexed by node. */
+	TArray<FNodeStateSlot> Slots;
+};
+
+/**
+ * Publishes the game flow asset instance currently executing nodes on the game thread.
+ * Nodes shared between instances use it to find the instance they are running for.
+ */
+class GAMEFLOW_API FGameFlowInstanceScope
+{
+public:
+	explicit FGameFlowInstanceScope(UGameFlowAsset* Instance);
+	~FGameFlowInstanceScope();
+
+	/** Get the innermost executing instance, nullptr if no instance is executing. */
+	static UGameFlowAsset* GetCurrent() { return CurrentInstance; }
+
+private:
+	UGameFlowAsset* PreviousInstance;
+
+	static UGameFlowAsset* CurrentInstance;
+};
@@ -0,0 +1,61 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGameFlowProgram;
+struct FStreamableHandle;
+
+/**
+ * Keeps the soft assets referenced by the nodes close to the active ones of a game flow instance loaded.
+ * A node becomes active when it is triggered, and stops being active once it has finished executing: right
+ * after its execution for immediate nodes, when it calls FinishExecute() for latent ones. Assets reachable
+ * only through the branches it did not take are then released.
+ */
+class GAMEFLOW_API FGameFlowPrefetcher
+{
+public:
+	FGameFlowPrefetcher() = default;
+	FGameFlowPrefetcher(const FGameFlowPrefetcher&) = delete;
+	FGameFlowPrefetcher& operator=(const FGameFlowPrefetcher&) = delete;
+	~FGameFlowPrefetcher() { Reset(); }
+
+	/**
+	 * Mark a node as active, loading the assets of the nodes within its reach.
+	 * @param Program The program of the instance. Should be the same for all calls until the next reset.
+	 * @param NodeIndex Index of the node inside the program nodes table.
+	 */
+	void Activate(const FGameFlowProgram& Program, int32 NodeIndex);
+
+	/** Mark a node as no longer active, releasing the assets no other active node can reach. */
+	void Deactivate(const FGameFlowProgram& Program, int32 NodeIndex);
+
+	/** Is a node currently keeping its reachable assets loaded? */
+	FORCEINLINE bool IsActive(int32 NodeIndex) const { return ActiveNodes.IsValidIndex(NodeIndex) && ActiveNodes[NodeIndex]; }
+
+	/** Get all the currently active nodes. */
+	void GetActiveNodes(TArray<int32>& OutNodes) const;
+
+	/** Release all the requested assets. */
+	void Reset();
+
+	/** The number of nodes whose assets are currently requested. */
+	FORCEINLINE int32 GetNumRequests() const { return Requests.Num(); }
+
+	/** Size in bytes of the memory allocated by the prefetcher, requested assets excluded. */
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return Requests.GetAllocatedSize() + ActiveNodes.GetAllocatedSize(); }
+
+private:
+	struct FRequest
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		int32 RefCount = 0;
+	};
+
+	/** Requested assets, keyed by the index of the node referencing them. */
+	TMap<int32, FRequest> Requests;
+
+	/** Nodes currently active. */
+	TBitArray<> ActiveNodes;
+};
@@ -0,0 +1,289 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFlowProgram.generated.h"
+
+class UGameFlowAsset;
+class UGameFlowNode;
+class UPinHandle;
+
+/**
+ * A single node entry inside a compiled game flow program.
+ * Node pins are stored as contiguous ranges inside the program pin tables.
+ */
+USTRUCT()
+struct GAMEFLOW_API FGameFlowProgramNode
+{
+	GENERATED_BODY()
+
+	/** The node object executed by this entry. */
+	UPROPERTY()
+	TObjectPtr<UGameFlowNode> Node = nullptr;
+
+	/** Index of the first node input pin inside the program input pins table. */
+	UPROPERTY()
+	int32 FirstInput = 0;
+
+	/** The number of input pins owned by the node. */
+	UPROPERTY()
+	int32 NumInputs = 0;
+
+	/** Index of the first node output pin inside the program output pins table. */
+	UPROPERTY()
+	int32 FirstOutput = 0;
+
+	/** The number of output pins owned by the node. */
+	UPROPERTY()
+	int32 NumOutputs = 0;
+
+	/** True if this node has been flattened away by the subgraph inlining pass, and is never executed. */
+	UPROPERTY()
+	bool bInlined = false;
+
+	/** Offset of the node state inside the instance state block, INDEX_NONE if the node is stateless. */
+	int32 StateOffset = INDEX_NONE;
+
+	/** Index of the first node to preload when this node executes, inside the program preload targets table. */
+	int32 FirstPreload = 0;
+
+	/** The number of nodes to preload when this node executes. */
+	int32 NumPreload = 0;
+
+	/** Index of the first node whose assets should be loaded while this node is active, inside the program prefetch targets table. */
+	int32 FirstPrefetch = 0;
+
+	/** The number of nodes whose assets should be loaded while this node is active. */
+	int32 NumPrefetch = 0;
+
+	/** Index of the first asset referenced by this node, inside the program prefetch paths table. */
+	int32 FirstPrefetchPath = 0;
+
+	/** The number of assets referenced by this node. */
+	int32 NumPrefetchPaths = 0;
+};
+
+/**
+ * A single pin entry inside a compiled game flow program.
+ */
+USTRUCT()
+struct GAMEFLOW_API FGameFlowProgramPin
+{
+	GENERATED_BODY()
+
+	/** The name of the pin, as declared by the node. */
+	UPROPERTY()
+	FName PinName;
+
+	/** Index of the node who owns this pin inside the program nodes table. */
+	UPROPERTY()
+	int32 NodeIndex = INDEX_NONE;
+
+	/** Output pins only: index of the first pin connection inside the program edges table. */
+	UPROPERTY()
+	int32 FirstEdge = 0;
+
+	/** Output pins only: the number of connections starting from this pin. */
+	UPROPERTY()
+	int32 NumEdges = 0;
+
+#if WITH_EDITORONLY_DATA
+	/** The pin handle this entry has been compiled from. Used to forward debug events to the editor. */
+	UPROPERTY(Transient)
+	TObjectPtr<UPinHandle> Handle = nullptr;
+#endif
+};
+
+/**
+ * Where a node inlined from a subgraph comes from, kept to map the flattened program back to the authored assets.
+ */
+USTRUCT()
+struct GAMEFLOW_API FGameFlowProgramNodeSource
+{
+	GENERATED_BODY()
+
+	/** The asset the node has been authored in. */
+	UPROPERTY()
+	TSoftObjectPtr<UGameFlowAsset> Asset;
+
+	/** The name of the node object inside the authoring asset. */
+	UPROPERTY()
+	FName NodeName;
+
+	/** Index of the subgraph node the node has been inlined from, inside the program nodes table. */
+	UPROPERTY()
+	int32 SubgraphNodeIndex = INDEX_NONE;
+};
+
+/**
+ * Flat, index-based representation of a game flow asset graph.
+ * Nodes, pins and connections are lowered into contiguous tables, with
+ * output pin connections stored in CSR form (each output pin owns a range
+ * of the edges table, each edge being an index inside the input pins table),
+ * so that the runtime can walk the graph without chasing pin handle objects.
+ */
+USTRUCT()
+struct GAMEFLOW_API FGameFlowProgram
+{
+	GENERATED_BODY()
+
+	/** All the compiled nodes, indexed by node ID. */
+	UPROPERTY()
+	TArray<FGameFlowProgramNode> Nodes;
+
+	/** All the compiled input pins, grouped by node. */
+	UPROPERTY()
+	TArray<FGameFlowProgramPin> InputPins;
+
+	/** All the compiled output pins, grouped by node. */
+	UPROPERTY()
+	TArray<FGameFlowProgramPin> OutputPins;
+
+	/** Output pins connections. Each value is an index inside the input pins table. */
+	UPROPERTY()
+	TArray<int32> Edges;
+
+	/** Asset entry points, mapped to their node index. */
+	UPROPERTY()
+	TMap<FName, int32> EntryPoints;
+
+	/** Source of each node, only filled when subgraphs have been inlined. */
+	UPROPERTY()
+	TArray<FGameFlowProgramNodeSource> NodeSources;
+
+	/** Nodes to preload ahead of each node execution, grouped by node. Each value is an index inside the nodes table. */
+	TArray<int32> PreloadTargets;
+
+	/** Nodes to preload as soon as an instance of the program is created. */
+	TArray<int32> InitialPreloads;
+
+	/** Nodes whose assets should be loaded while each node is active, grouped by node. Each value is an index inside the nodes table. */
+	TArray<int32> PrefetchTargets;
+
+	/** Soft assets referenced by the nodes, grouped by node. */
+	TArray<FSoftObjectPath> PrefetchPaths;
+
+private:
+	/** True if this program has been compiled at least once. */
+	UPROPERTY()
+	bool bIsCompiled = false;
+
+	/** Size in bytes of the instance state block. */
+	int32 StateSize = 0;
+
+	/** Alignment of the instance state block. */
+	int32 StateAlignment = 1;
+
+	/** True if all the compiled nodes keep their mutable state inside the instance state block. */
+	bool bCanShareNodes = false;
+
+	/** Hash of the nodes, pins and state structs layout, stable between runs. */
+	uint32 LayoutHash = 0;
+
+public:
+	/**
+	 * Lower the graph of a game flow asset into this program. Needs the editor-only pin objects,
+	 * cooked builds run the program compiled when the asset has been saved.
+	 * @param Asset The asset to compile.
+	 */
+	void Compile(const UGameFlowAsset* Asset);
+
+	/** Clear all the compiled data. */
+	void Reset();
+
+#if WITH_EDITOR
+	/**
+	 * Flatten the subgraphs statically referenced by the compiled nodes into this program, so that
+	 * entering and leaving them costs no asset instance nor entry/exit node hop at runtime.
+	 * Nodes coming from subgraphs are duplicated inside the owner asset. Meant to run at cook time,
+	 * does nothing if the program has already been flattened.
+	 * @param Owner The asset this program belongs to.
+	 * @param OutDuplicatedNodes Filled with the nodes duplicated inside the owner asset, to be trashed once saved.
+	 * @return True if at least one subgraph has been inlined.
+	 */
+	bool InlineSubgraphs(UGameFlowAsset* Owner, TArray<UGameFlowNode*>& OutDuplicatedNodes);
+#endif
+
+	/**
+	 * Compute the layout of the per-instance nodes state block. The layout is not serialized,
+	 * as state structs may differ between editor and cooked builds, and should be updated
+	 * whenever the program is loaded or duplicated.
+	 */
+	void UpdateStateLayout();
+
+	/**
+	 * Compute which nodes should start loading their content ahead of execution, following
+	 * UGameFlowRuntimeSettings::SubgraphPreloadHops.
+	 */
+	void UpdatePreloadTable();
+
+	/**
+	 * Compute which assets should be loaded while each node is active, gathering the soft
+	 * references of the nodes within UGameFlowRuntimeSettings::AssetPrefetchHops connections.
+	 */
+	void UpdatePrefetchTable();
+
+	/** Update the state layout and rebuild the preload and prefetch tables, once compiled or loaded. */
+	void UpdateRuntimeTables();
+
+	/**
+	 * Copy the preload and prefetch tables of the program this one has been duplicated from,
+	 * instead of walking the graph again. Both programs must have the same nodes.
+	 */
+	void CopyLoadingTables(const FGameFlowProgram& Other);
+
+	/** Size in bytes of the per-instance nodes state block. */
+	FORCEINLINE int32 GetStateSize() const { return StateSize; }
+
+	/** Size in bytes of the memory allocated by the program tables. */
+	SIZE_T GetAllocatedSize() const;
+
+	/** Hash identifying the layout of the program tables and of the nodes state, used to validate instance snapshots. */
+	FORCEINLINE uint32 GetLayoutHash() const { return LayoutHash; }
+
+	/** Alignment of the per-instance nodes state block. */
+	FORCEINLINE int32 GetStateAlignment() const { return StateAlignment; }
+
+	/**
+	 * Get where a node has been authored, when it comes from an inlined subgraph.
+	 * @return The node source, nullptr if the node belongs to the compiled asset.
+	 */
+	const FGameFlowProgramNodeSource* GetNodeSource(int32 NodeIndex) const;
+
+	/** Does any node of this program reference assets to prefetch? */
+	FORCEINLINE bool HasPrefetchPaths() const { return PrefetchPaths.Num() > 0; }
+
+	/** Can instances share the compiled nodes, owning only a state block? */
+	FORCEINLINE bool CanShareNodes() const { return bCanShareNodes; }
+
+	/** Is this program ready to be executed? */
+	FORCEINLINE bool IsCompiled() const { return bIsCompiled; }
+
+	/**
+	 * Find a node output pin by name.
+	 * @return The index of the pin inside the output pins table, INDEX_NONE if not found.
+	 */
+	int32 FindOutputPin(int32 NodeIndex, FName PinName) const;
+
+	/**
+	 * Find a node input pin by name.
+	 * @return The index of the pin inside the input pins table, INDEX_NONE if not found.
+	 */
+	int32 FindInputPin(int32 NodeIndex, FName PinName) const;
+
+private:
+	/**
+	 * Collect the nodes reachable from a node by following at most MaxHops connections, in breadth-first order.
+	 * @param OutNodes Filled with the reached nodes, starting with NodeIndex itself.
+	 */
+	void CollectReachableNodes(int32 NodeIndex, int32 MaxHops, TArray<int32>& OutNodes) const;
+	
+#if WITH_EDITOR
+	/**
+	 * Merge the programs of all the subgraphs referenced by this program, inlining theirs first.
+	 * @param AssetStack The assets being inlined, used to skip recursive subgraphs.
+	 */
+	bool InlineSubgraphsRecursive(TArray<const UGameFlowAsset*>& AssetStack);
+#endif
+};
@@ -0,0 +1,108 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFlowScheduler.generated.h"
+
+class UGameFlowAsset;
+
+/** Priority class of a game flow asset, deciding which instances run first when the frame budget is tight. */
+UENUM(BlueprintType)
+enum class EGameFlowPriority : uint8
+{
+	/** Always executed right away, ignoring the frame budget. */
+	Critical,
+	/** Executed before any other budgeted flow, e.g. main quests. */
+	High,
+	Normal,
+	/** Executed only when there is budget left, e.g. ambient flows. */
+	Low,
+	
+	Num UMETA(Hidden)
+};
+
+/** Statistics about the work executed and deferred by the game flow scheduler. */
+USTRUCT(BlueprintType)
+struct GAMEFLOW_API FGameFlowSchedulerStats
+{
+	GENERATED_BODY()
+
+	/** The number of node activations executed. */
+	UPROPERTY(BlueprintReadOnly, Category="Game Flow")
+	int32 ExecutedActivations = 0;
+
+	/** The number of node activations carried over to the next frame. */
+	UPROPERTY(BlueprintReadOnly, Category="Game Flow")
+	int32 DeferredActivations = 0;
+
+	/** The number of instances which had work carried over to the next frame. */
+	UPROPERTY(BlueprintReadOnly, Category="Game Flow")
+	int32 DeferredInstances = 0;
+
+	/** Game thread time spent executing nodes, in milliseconds. */
+	UPROPERTY(BlueprintReadOnly, Category="Game Flow")
+	float TimeSpentMs = 0.f;
+};
+
+/**
+ * Drains the work queues of game flow instances under a per-frame time budget.
+ * Instances run right away while the frame has budget left, otherwise they wait
+ * inside a queue for their priority class and are resumed during the next frames,
+ * higher priorities first.
+ */
+class GAMEFLOW_API FGameFlowScheduler
+{
+public:
+	/** Execute the pending work of an instance, within the budget left for the current frame. */
+	void Run(UGameFlowAsset* Instance);
+
+	/** Resume the work carried over from the previous frames. */
+	void Tick();
+
+	/** Forget about the carried over work of an instance, e.g. when it is reset. */
+	void Unschedule(UGameFlowAsset* Instance);
+
+	/** Is there any instance waiting for budget? */
+	bool HasPendingWork() const;
+
+	/** Get the statistics of the last completed frame. */
+	FORCEINLINE const FGameFlowSchedulerStats& GetLastFrameStats() const { return LastFrameStats; }
+
+private:
+	/** Start tracking a new frame, if it is not the one being tracked. */
+	void BeginFrameIfNeeded();
+
+	/** Add an instance to the waiting queue of its priority class. */
+	void Schedule(UGameFlowAsset* Instance);
+
+	/**
+	 * Drain an instance work queue until the frame budget is exhausted.
+	 * @return True if the instance has no more pending work.
+	 */
+	bool Drain(UGameFlowAsset* Instance);
+
+	/** Is there no budget left for the given priority during this frame? */
+	bool IsOutOfBudget(EGameFlowPriority Priority) const;
+
+	/** Instances waiting for budget, one queue per priority class. */
+	TArray<TWeakObjectPtr<UGameFlowAsset>> WaitingInstances[static_cast<int32>(EGameFlowPriority::Num)];
+
+	/** The frame the current stats refer to. */
+	uint64 CurrentFrame = 0;
+
+	/** Budget of the current frame, in seconds. 0 if unlimited. */
+	double FrameBudget = 0.0;
+
+	/** Time spent by budgeted instances during the current frame, in seconds. */
+	double FrameTimeSpent = 0.0;
+
+	/** Number of drains in progress, greater than 1 when draining from inside a node execution. */
+	int32 DrainDepth = 0;
+
+	/** When the outermost drain in progress started, in seconds. */
+	double DrainStartTime = 0.0;
+	
+	FGameFlowSchedulerStats CurrentFrameStats;
+	FGameFlowSchedulerStats LastFrameStats;
+};
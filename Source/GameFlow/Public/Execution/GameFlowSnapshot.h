@@ -0,0 +1,41 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Versions of the game flow instance snapshot format. */
+enum class EGameFlowSnapshotVersion : uint16
+{
+	Initial = 1,
+
+	// New versions go above this line.
+	LatestPlusOne,
+	Latest = LatestPlusOne - 1
+};
+
+/**
+ * Header of a game flow instance snapshot. Snapshots can only be restored on instances
+ * of an asset whose compiled program has the same layout as the one they were taken from.
+ */
+struct GAMEFLOW_API FGameFlowSnapshotHeader
+{
+	static constexpr uint32 Magic = 0x53534647; // "GFSS"
+	
+	uint32 Tag = Magic;
+	uint16 Version = static_cast<uint16>(EGameFlowSnapshotVersion::Latest);
+	
+	/** Layout hash of the program the snapshot has been taken from. */
+	uint32 LayoutHash = 0;
+
+	/** Is the header readable by this build? */
+	FORCEINLINE bool IsValid() const
+	{
+		return Tag == Magic && Version > 0 && Version <= static_cast<uint16>(EGameFlowSnapshotVersion::Latest);
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FGameFlowSnapshotHeader& Header)
+	{
+		return Ar << Header.Tag << Header.Version << Header.LayoutHash;
+	}
+};
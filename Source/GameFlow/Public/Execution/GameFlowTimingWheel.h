@@ -0,0 +1,227 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class UGameFlowAsset;
+class UGameFlowNode;
+
+/**
+ * Reference to a timer scheduled inside the game flow timing wheel.
+ * Becomes stale once the timer is cleared or expires without looping.
+ */
+struct GAMEFLOW_API FGameFlowTimerHandle
+{
+	FGameFlowTimerHandle() = default;
+	
+	FGameFlowTimerHandle(int32 InIndex, uint32 InGeneration)
+		: Index(InIndex), Generation(InGeneration)
+	{
+	}
+
+	/** Has this handle ever been assigned to a timer? Does not mean the timer is still active. */
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+
+	/** Forget the referenced timer, without clearing it. */
+	FORCEINLINE void Invalidate() { Index = INDEX_NONE; Generation = 0; }
+
+	FORCEINLINE int32 GetIndex() const { return Index; }
+	FORCEINLINE uint32 GetGeneration() const { return Generation; }
+
+private:
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+};
+
+/**
+ * Hierarchical timing wheel driving all the timers of game flow nodes.
+ * Time is quantized in ticks of fixed resolution, and timers are bucketed by their expiration
+ * tick inside wheels of growing span. Each frame only the due buckets are visited, so expiring
+ * timers costs O(expired) regardless of how many timers are pending, and timers never allocate
+ * once the timers pool has grown.
+ *
+ * Timers belong to a game flow instance and run in its local time: each instance can be paused
+ * and time dilated independently. When a timer expires, its node is notified through
+ * UGameFlowNode::OnTimerExpired() while the owner instance is executing.
+ */
+class GAMEFLOW_API FGameFlowTimingWheel
+{
+public:
+	/** @param InResolution Duration of a wheel tick, in seconds. */
+	explicit FGameFlowTimingWheel(double InResolution = 0.01);
+
+	/**
+	 * Schedule a new timer.
+	 * @param Instance The instance the timer belongs to.
+	 * @param Node The node to notify when the timer expires.
+	 * @param Payload Node-defined value passed back to the node on expiration.
+	 * @param Interval Expiration time, in seconds of the instance local time.
+	 * @param bLoop If true, the timer will be rescheduled after each expiration.
+	 */
+	FGameFlowTimerHandle SetTimer(UGameFlowAsset* Instance, UGameFlowNode* Node, int32 Payload, float Interval, bool bLoop);
+
+	/** Remove a timer, invalidating the handle. */
+	void ClearTimer(FGameFlowTimerHandle& Handle);
+
+	/** Remove all the timers of an instance. */
+	void ClearAllTimers(const UGameFlowAsset* Instance);
+
+	/** Stop a single timer, until it gets unpaused. */
+	void PauseTimer(FGameFlowTimerHandle Handle);
+
+	/** Resume a single paused timer. */
+	void UnPauseTimer(FGameFlowTimerHandle Handle);
+	
+	/** Is the timer scheduled and not paused? */
+	bool IsTimerActive(FGameFlowTimerHandle Handle) const;
+
+	/** Is the timer scheduled but paused? */
+	bool IsTimerPaused(FGameFlowTimerHandle Handle) const;
+
+	/** Get the instance local time elapsed since the timer has been scheduled, -1 if the timer does not exist. */
+	float GetTimerElapsed(FGameFlowTimerHandle Handle) const;
+
+	/**
+	 * Write a timer to a snapshot, or recreate it from one with the time it had left.
+	 * Stale handles are written as no timer, and read back as invalid handles.
+	 * @param Handle The timer to write, or the handle of the recreated timer.
+	 * @param Instance The instance the recreated timer belongs to.
+	 * @param Node The node to notify when the recreated timer expires.
+	 */
+	void SerializeTimer(FArchive& Ar, FGameFlowTimerHandle& Handle, UGameFlowAsset* Instance, UGameFlowNode* Node);
+
+	/** Pause or resume all the timers of an instance. */
+	void SetInstancePaused(UGameFlowAsset* Instance, bool bPaused);
+
+	/** Change the speed at which time flows for all the timers of an instance. */
+	void SetInstanceTimeDilation(UGameFlowAsset* Instance, float TimeDilation);
+
+	/** Pause or resume all the timers. */
+	FORCEINLINE void SetPaused(bool bPaused) { bIsPaused = bPaused; }
+	FORCEINLINE bool IsPaused() const { return bIsPaused; }
+
+	/** Is there any scheduled timer? */
+	FORCEINLINE bool HasTimers() const { return NumScheduled > 0; }
+
+	/** Has an instance any timer whose remaining time is flowing? */
+	bool HasRunningTimers(const UGameFlowAsset* Instance) const;
+
+	/**
+	 * Move time forward, expiring all the due timers.
+	 * @param DeltaTime Elapsed time, in seconds.
+	 */
+	void Advance(float DeltaTime);
+
+private:
+	static constexpr int32 NumLevels = 4;
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 NumSlots = 1 << SlotBits;
+	static constexpr int32 SlotMask = NumSlots - 1;
+	
+	enum class ETimerState : uint8
+	{
+		Free,
+		/** Stored inside a wheel slot. */
+		Scheduled,
+		/** Not stored inside any wheel slot, waiting to be unpaused. */
+		Paused,
+		/** Removed from its wheel slot, waiting for its node to be notified. */
+		Expiring
+	};
+	
+	struct FTimer
+	{
+		TObjectKey<UGameFlowAsset> Instance;
+		TWeakObjectPtr<UGameFlowNode> Node;
+		int32 Payload = 0;
+		float Interval = 0.f;
+		bool bLoop = false;
+		
+		/** True if the timer has been paused on its own, rather than with its instance. */
+		bool bUserPaused = false;
+		ETimerState State = ETimerState::Free;
+		uint32 Generation = 1;
+		
+		/** Wheel tick at which the timer expires. Valid while scheduled. */
+		int64 ExpireTick = 0;
+		
+		/** Instance local time left before expiration. Valid while paused. */
+		float Remaining = 0.f;
+
+		/** Index of the wheel slot storing the timer. */
+		int32 Slot = INDEX_NONE;
+		
+		/** Wheel slot list links, free list link when the timer is free. */
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+
+		/** Instance timers list links. */
+		int32 InstancePrev = INDEX_NONE;
+		int32 InstanceNext = INDEX_NONE;
+	};
+
+	/** Per-instance clock. */
+	struct FInstanceClock
+	{
+		float TimeDilation = 1.f;
+		bool bPaused = false;
+		
+		/** Head of the instance timers list. */
+		int32 FirstTimer = INDEX_NONE;
+	};
+
+	FTimer* FindTimer(FGameFlowTimerHandle Handle);
+	const FTimer* FindTimer(FGameFlowTimerHandle Handle) const;
+	
+	int32 AllocateTimer();
+	void FreeTimer(int32 TimerIndex);
+
+	/** Store a timer inside the wheel slot matching its expiration tick. */
+	void Insert(int32 TimerIndex);
+
+	/** Store a timer inside a given wheel slot. */
+	void Link(int32 TimerIndex, int32 Slot);
+
+	/** Remove a timer from its wheel slot. */
+	void Unlink(int32 TimerIndex);
+
+	/** Schedule a timer to expire after the given amount of instance local time. */
+	void ScheduleIn(int32 TimerIndex, float LocalTime, const FInstanceClock& Clock);
+
+	/** Take all the scheduled timers of an instance out of the wheel, remembering their remaining time. */
+	void Suspend(const FInstanceClock& Clock);
+
+	/** Put back inside the wheel all the timers of an instance which are not paused on their own. */
+	void Resume(const FInstanceClock& Clock);
+
+	/** Get the instance local time left before a scheduled timer expires. */
+	float GetRemaining(const FTimer& Timer, const FInstanceClock& Clock) const;
+	
+	/** Move all the timers of a wheel slot to lower levels. */
+	void Cascade(int32 Level);
+
+	/** Move forward of a single tick, collecting all the due timers. */
+	void Step();
+	
+	/** Notify the nodes of all the collected timers. */
+	void FireExpired();
+
+	double Resolution;
+	double Accumulator = 0.0;
+	int64 CurrentTick = 0;
+	bool bIsPaused = false;
+	int32 NumScheduled = 0;
+
+	TArray<FTimer> Timers;
+	int32 FirstFreeTimer = INDEX_NONE;
+	
+	/** Head of each wheel slot timers list, level by level. */
+	int32 Slots[NumLevels * NumSlots];
+
+	TMap<TObjectKey<UGameFlowAsset>, FInstanceClock> Clocks;
+
+	/** Timers due during the current advance, with the generation they had when collected. */
+	TArray<TPair<int32, uint32>> ExpiredTimers;
+};
@@ -0,0 +1,90 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFlowWorkQueue.generated.h"
+
+/** The order used by a game flow asset to run pending node activations. */
+UENUM(BlueprintType)
+enum class EGameFlowExecutionOrder : uint8
+{
+	/** Nodes are executed in the same order as a recursive walk of the graph (each branch is completed before the next one). */
+	DepthFirst,
+	/** Nodes are executed in trigger order (FIFO), one graph level at a time. */
+	BreadthFirst
+};
+
+/** A pending node execution, triggered by one of its input pins. */
+struct FGameFlowActivation
+{
+	/** Index of the node to execute inside the program nodes table. */
+	int32 NodeIndex = INDEX_NONE;
+
+	/** Index of the triggered pin inside the program input pins table. INDEX_NONE for asset entry points. */
+	int32 InputPinIndex = INDEX_NONE;
+};
+
+/**
+ * Explicit work queue used to execute game flow nodes iteratively.
+ * Activations triggered while a node is executing are collected into a batch,
+ * which is committed to the queue once the node returns, so the stack depth
+ * does not grow with the length of the executed graph.
+ */
+class GAMEFLOW_API FGameFlowWorkQueue
+{
+public:
+
+	FGameFlowWorkQueue(EGameFlowExecutionOrder InOrder = EGameFlowExecutionOrder::DepthFirst)
+		: Order(InOrder), Head(0)
+	{
+	}
+
+	/** Change the order used to pop activations. Should not be called while the queue is not empty. */
+	void SetOrder(EGameFlowExecutionOrder NewOrder) { Order = NewOrder; }
+
+	/** Add an activation to the current batch. */
+	FORCEINLINE void Push(const FGameFlowActivation& Activation) { Batch.Add(Activation); }
+
+	/** Move the current batch inside the queue. */
+	void CommitBatch();
+
+	/**
+	 * Pop the next activation from the queue.
+	 * @return False if the queue is empty.
+	 */
+	bool Pop(FGameFlowActivation& OutActivation);
+
+	/** Does the queue contain pending activations (committed or not)? */
+	FORCEINLINE bool IsEmpty() const { return Items.Num() - Head == 0 && Batch.Num() == 0; }
+
+	/** The number of pending activations (committed or not). */
+	FORCEINLINE int32 Num() const { return Items.Num() - Head + Batch.Num(); }
+
+	/** Size in bytes of the memory allocated by the queue. */
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return Items.GetAllocatedSize() + Batch.GetAllocatedSize(); }
+
+	/** Remove all pending activations, keeping the allocated memory. */
+	void Reset();
+
+	/**
+	 * Get all the pending activations (committed or not), in the order they will be popped.
+	 * Pushing them back in the same order and committing them restores the queue.
+	 */
+	void GetPendingActivations(TArray<FGameFlowActivation>& OutActivations) const;
+
+private:
+	EGameFlowExecutionOrder Order;
+
+	/**
+	 * Committed activations. Used as a stack for depth-first order. For breadth-first order, activations
+	 * are popped from Head and the array is only rewound once it has been fully drained.
+	 */
+	TArray<FGameFlowActivation> Items;
+
+	/** Activations triggered by the node currently being executed. */
+	TArray<FGameFlowActivation> Batch;
+
+	/** Breadth-first only: index of the next activation to pop. */
+	int32 Head;
+};
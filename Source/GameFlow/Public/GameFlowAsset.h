@@ -4,6 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
+#include "Execution/GameFlowInstanceHandle.h"
+#include "Execution/GameFlowInstanceState.h"
+#include "Execution/GameFlowPrefetcher.h"
+#include "Execution/GameFlowProgram.h"
+#include "Execution/GameFlowScheduler.h"
+#include "Execution/GameFlowWorkQueue.h"
 #include "Nodes/GameFlowNode.h"
 #include "Nodes/GameFlowNode_Input.h"
 #include "Nodes/GameFlowNode_Output.h"
@@ -11,6 +17,7 @@
 
 class UGameFlowNode_FlowControl_Subgraph;
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnFinish, UGameFlowAsset*)
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnExitPoint, UGameFlowAsset*, FName)
 
 /**
  * Game Flow asset is designed to help designer create their
@@ -23,6 +30,8 @@ class GAMEFLOW_API UGameFlowAsset : public UObject
 	friend class UGameFlowGraphSchema;
 	friend class GameFlowAssetToolkit;
 	friend class UGameFlowNode_Output;
+	friend class UGameFlowSubsystem;
+	friend class FGameFlowScheduler;
 	
 	GENERATED_BODY()
 
@@ -30,6 +39,30 @@ public:
 	/** If true, the game flow subsystem will not be allowed to create more than one instance of this asset.*/
 	UPROPERTY(EditDefaultsOnly, Category="Config")
 	bool bShouldBeSingleton;
+
+	/** The order in which nodes triggered during the same frame are executed. */
+	UPROPERTY(EditDefaultsOnly, Category="Config")
+	EGameFlowExecutionOrder ExecutionOrder;
+
+	/** Priority of the instances of this asset when the game flow scheduler runs out of frame budget. */
+	UPROPERTY(EditDefaultsOnly, Category="Config")
+	EGameFlowPriority Priority;
+
+	/**
+	 * If true, instances of this asset will share the graph nodes with it and only allocate
+	 * the nodes runtime state, as long as all the nodes support it. Otherwise each instance
+	 * will duplicate the whole graph.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category="Config")
+	bool bShareGraphBetweenInstances;
+
+	/**
+	 * The maximum number of finished instances of this asset the game flow subsystem
+	 * will keep around to be reused, instead of leaving them to the garbage collector.
+	 * Only instances sharing the graph with this asset can be recycled.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category="Config", meta=(ClampMin=0))
+	int32 MaxPooledInstances;
 	
 	/** All the user-defined entry points of the asset. */
 	UPROPERTY()
@@ -41,6 +74,47 @@ public:
 	
 	/** Called when this asset finishes executing. */
 	FOnFinish OnFinish;
+
+	/** Called when execution reaches one of the user-defined exit points, with the exit point name. */
+	FOnExitPoint OnExitPoint;
+
+private:
+	/** Flat representation of the asset graph walked by the runtime. Built on save/cook. */
+	UPROPERTY()
+	FGameFlowProgram Program;
+
+	/** The asset this instance shares its nodes and program with. nullptr if this instance owns its nodes. */
+	UPROPERTY(DuplicateTransient)
+	TObjectPtr<UGameFlowAsset> SourceAsset;
+
+	/** Per-instance runtime state of the shared nodes. */
+	FGameFlowInstanceState InstanceState;
+
+	/** Handle of this instance inside the game flow subsystem, invalid if the instance is not running. */
+	FGameFlowInstanceHandle InstanceHandle;
+
+	/** Keeps the assets referenced by the nodes execution is getting close to loaded. */
+	FGameFlowPrefetcher Prefetcher;
+
+	/** Node activations waiting to be executed during the current frame. */
+	FGameFlowWorkQueue WorkQueue;
+
+	/** Node activations waiting to be executed during the next frame. */
+	TArray<FGameFlowActivation> DeferredActivations;
+
+	/** True while the work queue is being drained. */
+	bool bIsRunningWorkQueue;
+
+	/** True while this instance is waiting for the game flow scheduler to resume its work. */
+	bool bIsScheduled;
+
+	/** True if a node has been executed or the instance state has changed since the last autosave. */
+	bool bIsSnapshotDirty;
+
+	/** Handle of the next tick flush of the deferred activations. */
+	FTimerHandle DeferredActivationsTimerHandle;
+
+public:
 	
 	UGameFlowAsset();
 
@@ -55,8 +129,136 @@ public:
 	 * Create an instance from this game flow asset.
 	 */
     UGameFlowAsset* CreateInstance(UObject* Context);
+
+	/**
+	 * Bring this instance back to the state it had when it was created, stopping
+	 * all its pending work, so that it can be executed again.
+	 */
+	void ResetInstance();
+
+	/**
+	 * Write the execution state of this instance to a compact binary snapshot: pending node activations,
+	 * active nodes and the per-instance state of all the stateful nodes, timers included.
+	 * @param OutData The snapshot, appended to the array.
+	 * @return False if the instance has never been executed nor initialized.
+	 */
+	bool SaveSnapshot(TArray<uint8>& OutData);
+
+	/**
+	 * Bring this instance back to the execution state written inside a snapshot, and resume its pending work.
+	 * @return False if the snapshot is malformed, of an unknown version or taken from a different program layout.
+	 */
+	bool RestoreSnapshot(const TArray<uint8>& Data);
+
+	/**
+	 * Lower the asset graph into a flat program which can be executed
+	 * without walking pin handle objects.
+	 */
+	void CompileProgram();
+
+	/** Get the compiled program of this asset, or the one of the source asset for shared instances. */
+	FORCEINLINE const FGameFlowProgram& GetProgram() const
+	{
+		return SourceAsset != nullptr? SourceAsset->Program : Program;
+	}
+
+	/** Get the handle of this instance inside the game flow subsystem, invalid if the instance is not running. */
+	FORCEINLINE FGameFlowInstanceHandle GetInstanceHandle() const { return InstanceHandle; }
+
+	/**
+	 * Get a node by its ID, without any lookup table.
+	 * @param NodeId The node ID, as returned by UGameFlowNode::GetNodeId().
+	 * @return The node, nullptr if the ID is invalid or the node has been flattened by subgraph inlining.
+	 */
+	FORCEINLINE UGameFlowNode* GetNodeById(int32 NodeId) const
+	{
+		const FGameFlowProgram& CurrentProgram = GetProgram();
+		return CurrentProgram.Nodes.IsValidIndex(NodeId)? CurrentProgram.Nodes[NodeId].Node.Get() : nullptr;
+	}
+
+	/** Is this instance sharing its nodes with the source asset? */
+	FORCEINLINE bool IsSharedInstance() const { return SourceAsset != nullptr; }
+
+	/**
+	 * Get the per-instance state of a node.
+	 * @param NodeIndex Index of the node inside the program nodes table.
+	 * @return The node state, nullptr if the node is stateless.
+	 */
+	FORCEINLINE void* GetNodeState(int32 NodeIndex) const { return InstanceState.GetNodeState(NodeIndex); }
+
+	/**
+	 * Trigger a compiled output pin, executing all the input pins connected to it during this frame.
+	 * When called while a node is being executed, connected nodes will run after it returns.
+	 * @param OutputPinIndex Index of the pin inside the program output pins table.
+	 */
+	void TriggerOutputPin(int32 OutputPinIndex);
+
+	/**
+	 * Trigger a compiled output pin, executing all the input pins connected to it during the next frame.
+	 * @param OutputPinIndex Index of the pin inside the program output pins table.
+	 */
+	void DeferOutputPin(int32 OutputPinIndex);
+
+	/**
+	 * Let go of the assets an active node keeps loaded, once it has finished executing.
+	 * @param NodeIndex Index of the node inside the program nodes table.
+	 */
+	void FinishNode(int32 NodeIndex);
+
+	virtual void PostLoad() override;
+	virtual void PostDuplicate(bool bDuplicateForPIE) override;
+	virtual void BeginDestroy() override;
+
+	/**
+	 * Loaded assets whose nodes keep their runtime state inside instances are never mutated at runtime,
+	 * let the garbage collector treat them and their nodes as a single cluster. Shared instances only
+	 * reference the cluster, so that each of them is reached as one unit.
+	 */
+	virtual bool CanBeClusterRoot() const override;
+
+	/** Report the memory used by this asset or instance, compiled program and runtime state included. */
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+	virtual void PostSave(FObjectPostSaveContext SaveContext) override;
+#endif
 	
 protected:
+
+	/**
+	 * Execute all the pending activations of the work queue. Instances owned by the game flow
+	 * subsystem are executed through its scheduler, and may carry work over to the next frames.
+	 */
+	void RunWorkQueue();
+
+	/**
+	 * Execute the pending activations of the work queue until it is empty or the deadline is reached.
+	 * At least one activation is always executed.
+	 * @param Deadline Platform time at which execution should stop, 0 to execute all activations.
+	 * @param OutNumExecuted Incremented by the number of executed activations.
+	 * @return True if there are no more pending activations.
+	 */
+	bool DrainWorkQueue(double Deadline, int32& OutNumExecuted);
+
+	/** Move all the activations deferred during the previous frame inside the work queue and run it. */
+	void FlushDeferredActivations();
+
+	/** Execute a node from one of its compiled input pins. */
+	void ExecuteActivation(const FGameFlowActivation& Activation);
+
+	/** (Re)allocate the runtime state of all the program nodes. */
+	void InitializeInstanceState();
+
+	/** Let the nodes which should be loaded along with the instance start loading their content. */
+	void PreloadInitialNodes();
+
+	/**
+	 * Move the assets prefetching window to the nodes connected to a triggered output pin.
+	 * The triggering node keeps its assets loaded until it finishes executing.
+	 * @param OutputPin The triggered pin.
+	 */
+	void AdvancePrefetching(const FGameFlowProgramPin& OutputPin);
 	
 	/**
 	* @brief Call this method when you need to terminate
@@ -83,6 +285,10 @@ private:
 	/* The nodes currently being executed. */
 	UPROPERTY(DuplicateTransient, Transient)
 	TArray<UGameFlowNode*> ActiveNodes;
+
+	/** Subgraph nodes duplicated inside this asset while it is being cooked, trashed once it has been saved. */
+	UPROPERTY(DuplicateTransient, Transient)
+	TArray<UGameFlowNode*> CookInlinedNodes;
 	
 public:
 	/**
@@ -102,9 +308,9 @@ public:
 	 * @brief Get the nodes which are currently being executed
 	 *        by the Game Flow asset.
 	 * @remarks Editor-only.
-	 * @return The currently executed node
+	 * @return The currently executed nodes, without copying them.
 	 */
-	TArray<UGameFlowNode*> GetActiveNodes() const { return ActiveNodes; }
+	FORCEINLINE TConstArrayView<UGameFlowNode*> GetActiveNodes() const { return ActiveNodes; }
 
 	/**
 	 * Adds a node to the Game Flow asset by its globally unique identifier (GUID),
@@ -127,9 +333,9 @@ public:
 	 * The nodes represent individual elements used in the node-based
 	 * editor for handling world and game events.
 	 *
-	 * @return An array of pointers to the Game Flow nodes.
+	 * @return The Game Flow nodes mapped by GUID, without copying them.
 	 */
-	TArray<UGameFlowNode*> GetNodes() const;
+	const TMap<FGuid, UGameFlowNode*>& GetNodes() const;
 	
 	/**
 	 * Get a node by its globally unique identifier.
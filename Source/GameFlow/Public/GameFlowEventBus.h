@@ -0,0 +1,77 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+class UGameFlowListener;
+
+/**
+ * A listener notification buffered by the game flow event bus.
+ */
+struct GAMEFLOW_API FGameFlowBusEvent
+{
+	/** The listener which sent the notification to game flow nodes, nullptr for notifications sent to listeners. */
+	TWeakObjectPtr<UGameFlowListener> Sender;
+
+	/** The notified tags. */
+	FGameplayTagContainer Tags;
+
+	/** Notifications sent to listeners only: how the listeners tags are matched. */
+	EGameplayContainerMatchType MatchType = EGameplayContainerMatchType::Any;
+
+	/** Notifications sent to listeners only: if valid, only listeners located inside the box are notified. */
+	FBox Box = FBox(ForceInit);
+
+	/** Notifications sent to listeners only: if the radius is positive, only listeners located inside the sphere are notified. */
+	FSphere Sphere = FSphere(ForceInit);
+
+	/** How many times this notification has been sent since the last flush. */
+	int32 Occurrences = 1;
+
+	bool IsSameNotification(const FGameFlowBusEvent& Other) const
+	{
+		return Sender == Other.Sender && MatchType == Other.MatchType && Tags == Other.Tags
+			&& Box == Other.Box && Sphere.Equals(Other.Sphere, 0.0);
+	}
+};
+
+/**
+ * Fixed-capacity ring buffer of listener notifications. Notifications sent more than once
+ * between two flushes are coalesced into a single event, keeping their occurrence count,
+ * so that each notification is dispatched once per frame regardless of how often it is sent.
+ */
+class GAMEFLOW_API FGameFlowEventBus
+{
+public:
+	explicit FGameFlowEventBus(int32 InCapacity = 256);
+
+	/**
+	 * Buffer a notification, merging it with an identical pending one.
+	 * @return False if the buffer is full, the notification should then be dispatched right away.
+	 */
+	bool Enqueue(FGameFlowBusEvent&& Event);
+
+	/**
+	 * Dispatch all the buffered notifications, in the order they have first been sent.
+	 * Notifications sent while flushing are buffered until the next flush.
+	 */
+	void Flush(TFunctionRef<void(const FGameFlowBusEvent&)> Dispatch);
+
+	/** Is there any notification waiting to be dispatched? */
+	FORCEINLINE bool HasPendingEvents() const { return NumEvents > 0; }
+
+private:
+	/** Order-independent hash of a notification. */
+	static uint32 HashEvent(const FGameFlowBusEvent& Event);
+	
+	TArray<FGameFlowBusEvent> Buffer;
+	
+	/** Sequence number of the oldest buffered notification. */
+	uint64 HeadSequence = 0;
+	int32 NumEvents = 0;
+
+	/** Sequence number of the pending notifications, by hash. */
+	TMap<uint32, uint64> PendingEvents;
+};
@@ -3,10 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameFlowTagMask.h"
 #include "GameplayTagContainer.h"
 #include "Components/ActorComponent.h"
 #include "GameFlowListener.generated.h"
 
+class UGameFlowSubsystem;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNotifyGameFlowListener, FGameplayTagContainer, GameplayTags);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReceiveGameFlowEvent, FGameplayTagContainer, GameplayTags);
 
@@ -31,14 +34,33 @@ public:
 	UPROPERTY(BlueprintCallable, Category="Game Flow")
 	FOnNotifyGameFlowListener OnNotifyGameFlowListener;
 	
+	/**
+	 * Send an event notification to the game flow nodes listening to this component.
+	 * Prefer it over broadcasting OnNotifyGameFlowListener directly, as it lets the game flow
+	 * subsystem coalesce notifications sent multiple times during the same frame.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void NotifyGameFlow(FGameplayTagContainer GameplayTags);
+	
 	UFUNCTION(BlueprintCallable, Category="Game Flow")
 	void AddGameplayTag(FGameplayTag GameplayTag);
 
 	UFUNCTION(BlueprintCallable, Category="Game Flow")
 	void RemoveGameplayTag(FGameplayTag GameplayTag);
+
+	/** Identity tags mask, parent tags included. Kept up to date on register and by Add/RemoveGameplayTag. */
+	FORCEINLINE const FGameFlowTagMask& GetIdentityMask() const { return IdentityMask; }
+
+	/** Identity tags mask, without parent tags. */
+	FORCEINLINE const FGameFlowTagMask& GetExactIdentityMask() const { return ExactIdentityMask; }
+
+	/** Match the identity tags against a tags query, using the cached masks when possible. */
+	bool MatchesTags(const FGameplayTagContainer& Tags, const FGameFlowTagMask& TagsMask, EGameplayContainerMatchType MatchType) const;
 	
 protected:
 	// Called when the game starts
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
 	virtual void BeginPlay() override;
 	virtual void DestroyComponent(bool bPromoteChildren) override;
     
@@ -46,4 +68,14 @@ public:
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
 	                           FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	/** Get the game flow subsystem tracking this listener, nullptr outside of game worlds. */
+	UGameFlowSubsystem* GetGameFlowSubsystem() const;
+
+	/** Rebuild the identity tags masks. */
+	void UpdateTagMasks();
+
+	FGameFlowTagMask IdentityMask;
+	FGameFlowTagMask ExactIdentityMask;
 };
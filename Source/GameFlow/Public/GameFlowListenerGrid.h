@@ -0,0 +1,53 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UGameFlowListener;
+
+/**
+ * Uniform spatial hash of game flow listeners, keyed by the location of their owner.
+ * Listeners are bucketed inside cubic cells, so that area queries only visit the cells
+ * overlapping the queried area, and moving listeners only touch the grid when they
+ * cross a cell boundary.
+ */
+class GAMEFLOW_API FGameFlowListenerGrid
+{
+public:
+	/** @param InCellSize Edge length of a grid cell, in world units. */
+	explicit FGameFlowListenerGrid(float InCellSize = 2000.f);
+
+	/** Insert a listener, or move it if already inside the grid. */
+	void Update(UGameFlowListener* Listener, const FVector& Location);
+
+	void Remove(UGameFlowListener* Listener);
+
+	/** Is the listener stored inside the grid? */
+	FORCEINLINE bool Contains(const UGameFlowListener* Listener) const { return Entries.Contains(Listener); }
+
+	/** Collect all the listeners located inside a box. */
+	void QueryBox(const FBox& Box, TArray<UGameFlowListener*>& OutListeners) const;
+
+	/** Collect all the listeners located inside a sphere. */
+	void QuerySphere(const FVector& Center, float Radius, TArray<UGameFlowListener*>& OutListeners) const;
+
+	void Reset();
+
+private:
+	struct FEntry
+	{
+		FVector Location;
+		FIntVector Cell;
+	};
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	/** Visit all the listeners stored inside the cells overlapping a box. */
+	void ForEachCandidate(const FBox& Box, TFunctionRef<void(UGameFlowListener*, const FVector&)> Visitor) const;
+
+	float CellSize;
+
+	TMap<FIntVector, TArray<UGameFlowListener*>> Cells;
+	TMap<UGameFlowListener*, FEntry> Entries;
+};
@@ -0,0 +1,52 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+class UGameFlowListener;
+
+/**
+ * Inverted index from gameplay tags to the game flow listeners identified by them.
+ * Each listener tag is indexed together with all its parent tags, so that tag queries
+ * follow the same hierarchical matching rules as FGameplayTagContainer::HasAny/HasAll,
+ * while only visiting the listeners indexed under the queried tags.
+ */
+struct GAMEFLOW_API FGameFlowListenerIndex
+{
+	/** Index a listener under all its current identity tags. */
+	void AddListener(UGameFlowListener* Listener);
+
+	/** Remove a listener from the index. */
+	void RemoveListener(UGameFlowListener* Listener);
+
+	/** Index a tag added to an already indexed listener. */
+	void AddTag(UGameFlowListener* Listener, FGameplayTag Tag);
+
+	/** Remove a tag from an already indexed listener. */
+	void RemoveTag(UGameFlowListener* Listener, FGameplayTag Tag);
+
+	/** Is the listener indexed? */
+	FORCEINLINE bool Contains(const UGameFlowListener* Listener) const { return ListenerTags.Contains(Listener); }
+
+	/**
+	 * Collect all the listeners matching a tags query. Does not allocate, besides growing the output array.
+	 * @param Tags The queried tags.
+	 * @param MatchType All: listeners must match every queried tag. Any: listeners must match at least one.
+	 * @param OutListeners Matching listeners are appended to this array.
+	 */
+	void Query(const FGameplayTagContainer& Tags, EGameplayContainerMatchType MatchType, TArray<UGameFlowListener*>& OutListeners) const;
+
+	void Reset();
+
+private:
+	/** Add (or remove, with a negative count) a tag and all its parents to the listener buckets. */
+	void UpdateBuckets(UGameFlowListener* Listener, FGameplayTag Tag, int32 Count);
+
+	/** Listeners indexed under each tag, with the number of listener tags matching it. */
+	TMap<FGameplayTag, TMap<UGameFlowListener*, int32>> Buckets;
+
+	/** Explicit tags each listener has been indexed with. */
+	TMap<UGameFlowListener*, FGameplayTagContainer> ListenerTags;
+};
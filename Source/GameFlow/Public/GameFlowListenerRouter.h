@@ -0,0 +1,99 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+class UGameFlowListener;
+
+/** The listener events routed to subscribers. */
+enum class EGameFlowListenerEvent : uint8
+{
+	Registered,
+	Unregistered,
+	TagAdded,
+	TagRemoved
+};
+
+/** Routed listener event. Tag is only valid for tag events. */
+DECLARE_DELEGATE_ThreeParams(FOnGameFlowListenerEvent, EGameFlowListenerEvent /* Event */, UGameFlowListener* /* Listener */, FGameplayTag /* Tag */);
+
+/**
+ * Reference to a subscription inside the game flow listener router.
+ */
+struct GAMEFLOW_API FGameFlowListenerSubscriptionHandle
+{
+	FGameFlowListenerSubscriptionHandle() = default;
+	
+	FGameFlowListenerSubscriptionHandle(int32 InIndex, uint32 InGeneration)
+		: Index(InIndex), Generation(InGeneration)
+	{
+	}
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+	FORCEINLINE void Invalidate() { Index = INDEX_NONE; Generation = 0; }
+	
+	FORCEINLINE int32 GetIndex() const { return Index; }
+	FORCEINLINE uint32 GetGeneration() const { return Generation; }
+
+private:
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+};
+
+/**
+ * Routes listener events only to the subscribers interested in the tags involved.
+ * Subscribers are filed under their tags and all their parents: a tag event reaches the
+ * subscribers filed under the changed tag or one of its parents, while register/unregister
+ * events reach the subscribers filed under any of the listener tags or their parents.
+ * Subscribers without tags receive all the events.
+ */
+struct GAMEFLOW_API FGameFlowListenerRouter
+{
+	/**
+	 * Start routing events to a subscriber.
+	 * @param Tags The tags the subscriber cares about, empty to receive all the events.
+	 * @param Delegate Called for each routed event.
+	 */
+	FGameFlowListenerSubscriptionHandle Subscribe(const FGameplayTagContainer& Tags, FOnGameFlowListenerEvent Delegate);
+
+	/** Stop routing events to a subscriber, invalidating the handle. Constant time. */
+	void Unsubscribe(FGameFlowListenerSubscriptionHandle& Handle);
+
+	/** Notify that a listener has been registered or unregistered. */
+	void DispatchListenerEvent(EGameFlowListenerEvent Event, UGameFlowListener* Listener);
+
+	/** Notify that a tag has been added to or removed from a listener. */
+	void DispatchTagEvent(EGameFlowListenerEvent Event, UGameFlowListener* Listener, FGameplayTag Tag);
+
+private:
+	struct FSubscription
+	{
+		FOnGameFlowListenerEvent Delegate;
+		uint32 Generation = 1;
+		
+		/** Last dispatch which has collected this subscription, used to skip duplicates. */
+		uint32 LastDispatch = 0;
+		
+		/** Free list link. */
+		int32 NextFree = INDEX_NONE;
+	};
+
+	/** Collect the live subscriptions of a route, dropping the stale ones. */
+	void CollectRoute(FGameplayTag Tag, TArray<FGameFlowListenerSubscriptionHandle, TInlineAllocator<16>>& OutHandles);
+
+	/** Collect the live subscriptions of the routes of a tag and of all its parents. */
+	void CollectRouteHierarchy(FGameplayTag Tag, TArray<FGameFlowListenerSubscriptionHandle, TInlineAllocator<16>>& OutHandles);
+
+	/** Call the collected subscriptions which are still alive. */
+	void Execute(TConstArrayView<FGameFlowListenerSubscriptionHandle> Handles, EGameFlowListenerEvent Event,
+		UGameFlowListener* Listener, FGameplayTag Tag);
+
+	TArray<FSubscription> Subscriptions;
+	int32 FirstFreeSubscription = INDEX_NONE;
+	uint32 DispatchCounter = 0;
+
+	/** Subscriptions filed under each tag. Wildcard subscriptions are filed under the empty tag. */
+	TMap<FGameplayTag, TArray<FGameFlowListenerSubscriptionHandle>> Routes;
+};
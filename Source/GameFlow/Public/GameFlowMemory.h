@@ -0,0 +1,28 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/** Low level memory tracker tags of the game flow modules. Sub-tags are reported under the "GameFlow" tag. */
+LLM_DECLARE_TAG_API(GameFlow, GAMEFLOW_API);
+LLM_DECLARE_TAG_API(GameFlow_Assets, GAMEFLOW_API);
+LLM_DECLARE_TAG_API(GameFlow_Instances, GAMEFLOW_API);
+LLM_DECLARE_TAG_API(GameFlow_Listeners, GAMEFLOW_API);
+LLM_DECLARE_TAG_API(GameFlow_EditorGraphs, GAMEFLOW_API);
+
+/** Memory used by a game flow asset and by the instances created from it. */
+struct GAMEFLOW_API FGameFlowAssetMemory
+{
+	/** Size in bytes of the asset, its nodes and their pins. */
+	SIZE_T AssetBytes = 0;
+
+	/** Size in bytes of all the running and pooled instances of the asset. */
+	SIZE_T InstanceBytes = 0;
+
+	/** The number of running and pooled instances of the asset. */
+	int32 NumInstances = 0;
+
+	FORCEINLINE SIZE_T GetTotalBytes() const { return AssetBytes + InstanceBytes; }
+};
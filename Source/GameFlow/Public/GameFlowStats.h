@@ -0,0 +1,50 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("GameFlow"), STATGROUP_GameFlow, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TryExecute"), STAT_GameFlow_TryExecute, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TriggerPin"), STAT_GameFlow_TriggerPin, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("NotifyListeners"), STAT_GameFlow_NotifyListeners, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RegisterAssetInstance"), STAT_GameFlow_RegisterAssetInstance, STATGROUP_GameFlow, GAMEFLOW_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Executed"), STAT_GameFlow_NodesExecuted, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pins Triggered"), STAT_GameFlow_PinsTriggered, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances Created"), STAT_GameFlow_InstancesCreated, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances Destroyed"), STAT_GameFlow_InstancesDestroyed, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Instances"), STAT_GameFlow_ActiveInstances, STATGROUP_GameFlow, GAMEFLOW_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Listeners"), STAT_GameFlow_ActiveListeners, STATGROUP_GameFlow, GAMEFLOW_API);
+
+/**
+ * Attributes the time spent executing nodes to game flow assets and node classes, over a sliding window
+ * of frames. Enabled with gameflow.Profile, results are printed by gameflow.top and gameflow.dump.
+ * Game thread only.
+ */
+class GAMEFLOW_API FGameFlowProfiler
+{
+public:
+	/** Should node executions be recorded? */
+	static bool IsEnabled();
+
+	/** Start timing a node execution. Node executions nested inside it are excluded from its time. */
+	static void BeginExecution();
+
+	/**
+	 * Stop timing the innermost node execution, and record its exclusive time.
+	 * @param AssetName The asset the executing instance has been created from.
+	 * @param NodeClass The class of the executed node.
+	 */
+	static void EndExecution(FName AssetName, const UClass* NodeClass);
+
+	/**
+	 * Record the execution of a node during the current frame.
+	 * @param AssetName The asset the executing instance has been created from.
+	 * @param NodeClass The class of the executed node.
+	 * @param Seconds Time spent executing the node, nested node executions excluded.
+	 */
+	static void RecordExecution(FName AssetName, const UClass* NodeClass, double Seconds);
+};
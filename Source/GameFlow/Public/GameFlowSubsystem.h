@@ -4,8 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFlowAsset.h"
+#include "GameFlowEventBus.h"
 #include "GameFlowListener.h"
+#include "GameFlowListenerGrid.h"
+#include "GameFlowListenerIndex.h"
+#include "GameFlowListenerRouter.h"
+#include "GameFlowMemory.h"
+#include "Execution/GameFlowAutosave.h"
+#include "Execution/GameFlowInstanceHandle.h"
+#include "Execution/GameFlowInstancePool.h"
+#include "Execution/GameFlowScheduler.h"
+#include "Execution/GameFlowTimingWheel.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
 #include "UObject/Object.h"
 #include "GameFlowSubsystem.generated.h"
 
@@ -14,28 +25,129 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnListenerComponentUnregistered, UG
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTagAdded, UGameFlowListener*, ListenerComponent, FGameplayTag, NewTag);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnTagRemoved, UGameFlowListener*, ListenerComponent, FGameplayTag, RemovedTag);
 
+/**
+ * A slot of the game flow subsystem instances registry.
+ */
+USTRUCT()
+struct FGameFlowInstanceSlot
+{
+	GENERATED_BODY()
+
+	/** The running instance, nullptr if the slot is free. */
+	UPROPERTY()
+	TObjectPtr<UGameFlowAsset> Instance = nullptr;
+
+	/** The asset the instance has been created from. */
+	UPROPERTY()
+	TObjectPtr<UGameFlowAsset> Source = nullptr;
+
+	/** The instance whose execution state includes this one, e.g. the parent of a subgraph. Invalid for standalone instances. */
+	FGameFlowInstanceHandle Owner;
+
+	/** Incremented each time the slot is freed, invalidating all the handles to the previous instance. */
+	uint32 Generation = 1;
+
+	/** Index of the instance inside the running instances array. */
+	int32 DenseIndex = INDEX_NONE;
+};
+
+/**
+ * A finished instance waiting to be given back to the pool of its asset.
+ */
+USTRUCT()
+struct FGameFlowPendingRelease
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UGameFlowAsset> Instance = nullptr;
+
+	/** The asset the instance has been created from. */
+	UPROPERTY()
+	TObjectPtr<UGameFlowAsset> Source = nullptr;
+};
+
 /**
  * Game Flow singleton which handles execution and lifetime of
  * game flow assets inside the game.
  */
 UCLASS(NotBlueprintable)
-class GAMEFLOW_API UGameFlowSubsystem : public UGameInstanceSubsystem
+class GAMEFLOW_API UGameFlowSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
 {
 	GENERATED_BODY()
 
 private:
 
-	/** All the currently executing game flow assets inside this world. */
+	/** Registry of all the currently executing game flow assets, addressed by instance handles. */
 	UPROPERTY()
-	TMap<UObject*, UGameFlowAsset*> InstancedAssets;
+	TArray<FGameFlowInstanceSlot> InstanceSlots;
+
+	/** Indices of all the free registry slots. */
+	TArray<int32> FreeInstanceSlots;
+
+	/** All the currently executing game flow assets inside this world, tightly packed. */
+	UPROPERTY()
+	TArray<UGameFlowAsset*> RunningInstances;
+
+	/** Handles of the running instances of singleton assets. */
+	TMap<const UGameFlowAsset*, FGameFlowInstanceHandle> SingletonInstances;
+
+	/** Executes the running instances under the frame budget. */
+	FGameFlowScheduler Scheduler;
+
+	/** Drives the timers of all the running instances. */
+	FGameFlowTimingWheel TimingWheel;
+
+	/** Encodes the autosaves of the running instances in the background. */
+	FGameFlowAutosaver Autosaver;
+
+	/** Autosave waiting for the end of the subsystem tick to be captured. */
+	TOptional<TPair<bool, FOnGameFlowAutosaved>> PendingAutosave;
 	
 	/** Instanced assets that share the lifetime of the world. */
 	UPROPERTY()
 	TArray<UGameFlowAsset*> WorldInstancedAssets;
+
+	/** Ready-to-run instances of each executed or prewarmed asset. */
+	UPROPERTY()
+	TMap<UGameFlowAsset*, FGameFlowInstancePool> InstancePools;
+
+	/** Instances which finished while executing their work queue, released to their pool once it unwinds. */
+	UPROPERTY()
+	TArray<FGameFlowPendingRelease> PendingReleases;
+
 	
 	/** All the game flow listeners inside the world. */
 	UPROPERTY()
-	TArray<UGameFlowListener*> Listeners;
+	TSet<TObjectPtr<UGameFlowListener>> Listeners;
+
+	/** Listeners of streamed levels being added to the world, registered all at once when the level becomes visible. */
+	UPROPERTY()
+	TArray<TObjectPtr<UGameFlowListener>> PendingListeners;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	/** Registered listeners, indexed by their identity tags. */
+	FGameFlowListenerIndex ListenerIndex;
+
+	/** Registered listeners, indexed by their location. Only used when spatial listener queries are enabled. */
+	FGameFlowListenerGrid ListenerGrid;
+
+	/** The components whose movements are tracked to keep the listeners grid up to date. */
+	TMap<UGameFlowListener*, TPair<TWeakObjectPtr<USceneComponent>, FDelegateHandle>> TrackedListenerComponents;
+
+	/** Routes listener events to the subscribers interested in them. */
+	FGameFlowListenerRouter ListenerRouter;
+
+	/** Buffers and coalesces listener notifications, when enabled in the runtime settings. */
+	FGameFlowEventBus EventBus;
+
+	/** Occurrences of the notification being dispatched. */
+	int32 DispatchedEventOccurrences = 0;
+
+	/** Scratch array receiving the listeners of the notification being dispatched, kept to reuse its allocation. */
+	TArray<UGameFlowListener*> DispatchedListeners;
 
 public:
 
@@ -45,24 +157,158 @@ public:
 	FOnTagRemoved OnGameplayTagRemoved;
 	
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+	/** Get the scheduler executing the running instances. */
+	FORCEINLINE FGameFlowScheduler& GetScheduler() { return Scheduler; }
+
+	/** Get statistics about the work executed and deferred by the scheduler during the last frame. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
+	FGameFlowSchedulerStats GetSchedulerStats() const;
+
+	/** Get the timing wheel driving the timers of the running instances. */
+	FORCEINLINE FGameFlowTimingWheel& GetTimingWheel() { return TimingWheel; }
+
+	/** Change the speed at which the timers of a running instance flow. 1 is real time, 0 stops them. */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void SetInstanceTimeDilation(FGameFlowInstanceHandle Handle, float TimeDilation);
+
+	/** Pause or resume all the timers of a running instance. */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void SetInstanceTimersPaused(FGameFlowInstanceHandle Handle, bool bPaused);
+
+	/** Pause or resume the timers of all the running instances at once. */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void SetTimersPaused(bool bPaused);
 	
-	UGameFlowAsset* RegisterAssetInstance(UGameFlowAsset* Asset);
+	/**
+	 * Get a new running instance of a game flow asset. Singleton assets will
+	 * return their running instance, if any.
+	 * @return The handle of the instance, invalid if the instance could not be created.
+	 */
+	FGameFlowInstanceHandle RegisterAssetInstance(UGameFlowAsset* Asset);
 	void UnregisterAssetInstance(UGameFlowAsset* AssetInstance);
+
+	/**
+	 * Declare that the execution state of a running instance is saved along with another one, e.g. as a nested
+	 * subgraph snapshot. Owned instances are never autosaved on their own, their owner is captured instead.
+	 * @param Handle The owned instance.
+	 * @param OwnerHandle The instance saving the owned one, invalid to make it standalone again.
+	 */
+	void SetInstanceOwner(FGameFlowInstanceHandle Handle, FGameFlowInstanceHandle OwnerHandle);
+
+	/** Give back to their pool the finished instances which are no longer executing their work queue. */
+	void FlushPendingReleases();
+
+	/**
+	 * Create instances of a game flow asset ahead of time, so that executing it later will not
+	 * need to allocate. Call it during level load or loading screens.
+	 * @param Asset The source asset.
+	 * @param Count The number of ready-to-run instances the subsystem should hold for the asset.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void PrewarmInstances(UGameFlowAsset* Asset, int32 Count);
 	
+	/**
+	 * Start tracking a listener. Listeners register themselves with their component,
+	 * listeners of a streamed level are registered in batch once the level is visible.
+	 */
 	void RegisterListener(UGameFlowListener* Listener);
 	void UnregisterListener(UGameFlowListener* Listener);
+
+	/** Is the listener tracked by this subsystem? */
+	FORCEINLINE bool IsListenerRegistered(const UGameFlowListener* Listener) const { return ListenerIndex.Contains(Listener); }
+
+	/** Keep the listeners index in sync with tags added to a registered listener. */
+	void AddListenerTag(UGameFlowListener* Listener, FGameplayTag Tag);
+
+	/** Keep the listeners index in sync with tags removed from a registered listener. */
+	void RemoveListenerTag(UGameFlowListener* Listener, FGameplayTag Tag);
+
+	/**
+	 * Receive the listener events involving some tags, without being woken up by unrelated ones.
+	 * @param Tags The tags the subscriber cares about, empty to receive all the events.
+	 * @param Delegate Called for each routed event.
+	 */
+	FGameFlowListenerSubscriptionHandle SubscribeToListenerEvents(const FGameplayTagContainer& Tags, FOnGameFlowListenerEvent Delegate);
+
+	/** Stop receiving listener events, invalidating the handle. */
+	void UnsubscribeFromListenerEvents(FGameFlowListenerSubscriptionHandle& Handle);
 	
     /** Execute a specific root on a given game flow asset.
      * @param Asset The source asset blueprint
      * @param RootName The name of the root to execute, defaults to "Start" node.
      */
 	UFUNCTION(BlueprintCallable, Category="Game Flow")
-	void Execute(UGameFlowAsset* Asset, FName RootName = "Start");
+	FGameFlowInstanceHandle Execute(UGameFlowAsset* Asset, FName RootName = "Start");
+
+	/**
+	 * Get a running instance by its handle.
+	 * @return The instance, nullptr if the handle is stale or invalid.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
+	UGameFlowAsset* GetInstance(FGameFlowInstanceHandle Handle) const;
+
+	/** Is the instance referenced by the handle still running? */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
+	bool IsInstanceRunning(FGameFlowInstanceHandle Handle) const;
+
+	/**
+	 * Write the execution state of a running instance to a compact, versioned binary snapshot,
+	 * meant to be stored inside save games.
+	 * @param OutData The snapshot, empty if the instance is not running.
+	 * @return True if the snapshot has been written.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	bool SaveInstance(FGameFlowInstanceHandle Handle, TArray<uint8>& OutData);
+
+	/**
+	 * Get a new running instance of a game flow asset, resuming the execution state written inside a snapshot.
+	 * @param Asset The asset the snapshot has been taken from.
+	 * @param Data A snapshot written by SaveInstance().
+	 * @return The handle of the instance, invalid if the snapshot could not be restored.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	FGameFlowInstanceHandle RestoreInstance(UGameFlowAsset* Asset, const TArray<uint8>& Data);
+
+	/**
+	 * Autosave all the running instances. Only the instances which executed a node or changed their state since
+	 * the previous autosave are captured, at the end of the next subsystem tick, and the autosave is encoded and
+	 * compressed on a background task as a delta against the previous one.
+	 * @param bFull If true, all the running instances are captured and the autosave does not depend on the previous ones.
+	 * @param OnComplete Called on the game thread with the encoded autosave.
+	 */
+	void RequestAutosave(bool bFull, FOnGameFlowAutosaved OnComplete);
+
+	/**
+	 * Add the memory used by the running and pooled instances to the usage of the asset they have been created from.
+	 * @param InOutUsage Memory used by each game flow asset.
+	 */
+	void CollectMemoryUsage(TMap<const UGameFlowAsset*, FGameFlowAssetMemory>& InOutUsage) const;
+
+	/** Terminate the execution of a running instance. Does nothing if the handle is stale or invalid. */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void StopInstance(FGameFlowInstanceHandle Handle);
+
+	/** Get all the currently running game flow assets inside the level, without copying them. */
+	FORCEINLINE TConstArrayView<UGameFlowAsset*> GetRunningInstances() const { return RunningInstances; }
 	
-	/** Get all the currently running game flow assets inside the level. */
+	/**
+	 * Get all the currently running game flow assets inside the level.
+	 * @remark Copies the running instances, native code should use GetRunningInstances() instead.
+	 */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
 	TArray<UGameFlowAsset*> GetRunningFlows() const;
 
+	/** Get the first running instance created from the given asset, nullptr if none is running. */
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
 	UGameFlowAsset* GetRunningFlowByArchetype(UObject* Archetype) const;
 	/**
@@ -73,7 +319,93 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
 	TArray<UGameFlowListener*> GetListenersByGameplayTags(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType) const;
 
+	/**
+	 * Collect all listeners with matching gameplay tags, without scanning all the registered listeners.
+	 * @param GameplayTag The tags used to search for the listeners.
+	 * @param MatchType Matching tag strategy.
+	 * @param OutListeners Matching listeners are appended to this array.
+	 */
+	void QueryListeners(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType, TArray<UGameFlowListener*>& OutListeners) const;
+
+	/**
+	 * Get all listeners with matching gameplay tags whose owner is located inside a sphere.
+	 * @param GameplayTag The tags used to search for the listeners.
+	 * @param MatchType Matching tag strategy.
+	 * @param Center The center of the sphere.
+	 * @param Radius The radius of the sphere.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
+	TArray<UGameFlowListener*> GetListenersByGameplayTagsInRadius(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType,
+		FVector Center, float Radius) const;
+
+	/**
+	 * Get all listeners with matching gameplay tags whose owner is located inside a box.
+	 * @param GameplayTag The tags used to search for the listeners.
+	 * @param MatchType Matching tag strategy.
+	 * @param Box The world space box.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
+	TArray<UGameFlowListener*> GetListenersByGameplayTagsInBox(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType,
+		FBox Box) const;
+
+	/** Collect all listeners with matching gameplay tags whose owner is located inside a sphere. */
+	void QueryListenersInRadius(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType,
+		const FVector& Center, float Radius, TArray<UGameFlowListener*>& OutListeners) const;
+
+	/** Collect all listeners with matching gameplay tags whose owner is located inside a box. */
+	void QueryListenersInBox(const FGameplayTagContainer& GameplayTag, EGameplayContainerMatchType MatchType,
+		const FBox& Box, TArray<UGameFlowListener*>& OutListeners) const;
+
 	/** Notify about a game flow event all component listeners with matching gameplay tag. */
 	UFUNCTION(BlueprintCallable, Category="Game Flow")
 	void NotifyListeners(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType);
+
+	/** Notify about a game flow event all component listeners with matching gameplay tag located inside a sphere. */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void NotifyListenersInRadius(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType, FVector Center, float Radius);
+
+	/** Notify about a game flow event all component listeners with matching gameplay tag located inside a box. */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void NotifyListenersInBox(FGameplayTagContainer GameplayTag, EGameplayContainerMatchType MatchType, FBox Box);
+
+	/** Notify about a listener event all the game flow nodes listening to the listener. */
+	void NotifyFromListener(UGameFlowListener* Listener, const FGameplayTagContainer& GameplayTags);
+
+	/**
+	 * Get how many times the notification currently being received has been sent since the previous
+	 * frame. Always 1 when listener events are not coalesced, 0 outside of notifications.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category="Game Flow")
+	int32 GetDispatchedEventOccurrences() const { return DispatchedEventOccurrences; }
+
+private:
+	/** Get the instance pool of an asset, creating it if needed. */
+	FGameFlowInstancePool& GetInstancePool(UGameFlowAsset* Asset);
+
+	/** Get the registry slot of a running instance, nullptr if the handle is stale or invalid. */
+	const FGameFlowInstanceSlot* FindSlot(FGameFlowInstanceHandle Handle) const;
+
+	/** Snapshot the instances changed since the previous autosave, and start encoding the pending autosave. */
+	void CaptureAutosave();
+
+	/** Buffer a notification on the event bus when enabled, dispatch it right away otherwise. */
+	void SendNotification(FGameFlowBusEvent&& Event);
+
+	/** Deliver a notification to its receivers. */
+	void DispatchNotification(const FGameFlowBusEvent& Event);
+
+	/** Keep a listener inside the spatial grid, following the movements of its owner. */
+	void TrackListenerLocation(UGameFlowListener* Listener);
+	void UntrackListenerLocation(UGameFlowListener* Listener);
+	void OnListenerMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport,
+		UGameFlowListener* Listener);
+
+	/** Start tracking a listener right away. */
+	void AddListener(UGameFlowListener* Listener);
+
+	/** Register the listeners of a streamed level once it has been added to the world. */
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+
+	/** Unregister at once all the listeners of a level removed from the world. */
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
 };
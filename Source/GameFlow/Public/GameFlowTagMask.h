@@ -0,0 +1,90 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/**
+ * Fixed-width bitset representation of a gameplay tag container. Each registered gameplay tag is
+ * assigned a dense bit index when the module starts up, so that container queries become a few
+ * word-wise AND/compare operations instead of tag container searches.
+ *
+ * Masks can be built with or without parent tags expansion: queries matching tags hierarchically
+ * (HasAll/HasAny) need the tested mask to be expanded, exact queries don't. Tags beyond the mask
+ * capacity make the mask overflow, in which case callers must fall back to tag containers.
+ */
+struct GAMEFLOW_API FGameFlowTagMask
+{
+	static constexpr int32 NumWords = 16;
+	static constexpr int32 MaxTags = NumWords * 64;
+
+	FGameFlowTagMask()
+	{
+		FMemory::Memzero(Words);
+	}
+
+	/**
+	 * Build the mask of a tag container.
+	 * @param Tags The tags to represent.
+	 * @param bExpandParents If true, the parents of each tag are added to the mask too.
+	 */
+	static FGameFlowTagMask Make(const FGameplayTagContainer& Tags, bool bExpandParents);
+
+	/**
+	 * Assign a bit index to each gameplay tag registered to the tags manager. Indices already assigned
+	 * are kept, so that masks built before the tags tree changed stay valid. Game thread only.
+	 */
+	static void BuildTagBits();
+
+	/** Get the bit index of a tag, INDEX_NONE if the tag is invalid or has no bit (e.g. beyond the mask capacity). */
+	static int32 GetTagBit(FGameplayTag Tag);
+
+	/** Can this mask be used for matching? False if some of its tags did not fit. */
+	FORCEINLINE bool IsValid() const { return !bOverflow; }
+
+	FORCEINLINE bool HasBit(int32 Bit) const
+	{
+		return Bit != INDEX_NONE && (Words[Bit >> 6] & (uint64(1) << (Bit & 63))) != 0;
+	}
+
+	/** Does this mask contain the tag? Matches parent tags if this mask has been expanded. */
+	FORCEINLINE bool HasTag(FGameplayTag Tag) const { return HasBit(GetTagBit(Tag)); }
+
+	/** Does this mask contain all the bits of the other mask? Always true if the other mask is empty. */
+	FORCEINLINE bool HasAll(const FGameFlowTagMask& Other) const
+	{
+		uint64 Missing = 0;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			Missing |= Other.Words[WordIndex] & ~Words[WordIndex];
+		}
+		return Missing == 0;
+	}
+
+	/** Does this mask contain any bit of the other mask? Always false if the other mask is empty. */
+	FORCEINLINE bool HasAny(const FGameFlowTagMask& Other) const
+	{
+		uint64 Common = 0;
+		for (int32 WordIndex = 0; WordIndex < NumWords; ++WordIndex)
+		{
+			Common |= Other.Words[WordIndex] & Words[WordIndex];
+		}
+		return Common != 0;
+	}
+
+	/** Match this mask against a query mask, following a container match type. */
+	FORCEINLINE bool Matches(const FGameFlowTagMask& Query, EGameplayContainerMatchType MatchType) const
+	{
+		return MatchType == EGameplayContainerMatchType::All? HasAll(Query) : HasAny(Query);
+	}
+
+private:
+	void SetBit(int32 Bit)
+	{
+		Words[Bit >> 6] |= uint64(1) << (Bit & 63);
+	}
+	
+	uint64 Words[NumWords];
+	bool bOverflow = false;
+};
@@ -28,7 +28,20 @@ public:
 	UPROPERTY(EditAnywhere, Category="Screen")
 	float Time;
 	
+	/** Log node input pins. */
+	enum class EInputPin : int32 { Exec, Num };
+
+	/** Log node output pins. */
+	enum class EOutputPin : int32 { Out, Num };
+
+	static const TGameFlowPins<EInputPin> InputPins;
+	static const TGameFlowPins<EOutputPin> OutputPins;
+	
 	UGameFlowNode_Debug_Log();
+
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const override { return InputPins.GetNames(); }
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const override { return OutputPins.GetNames(); }
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
 	
 	virtual void Execute_Implementation(const FName PinName) override;
 	virtual void OnFinishExecute_Implementation() override;
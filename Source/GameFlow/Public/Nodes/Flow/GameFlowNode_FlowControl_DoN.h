@@ -7,6 +7,17 @@
 #include "UObject/Object.h"
 #include "GameFlowNode_FlowControl_DoN.generated.h"
 
+/** Per-instance state of a Do N node. */
+USTRUCT()
+struct FGameFlowNode_FlowControl_DoN_State
+{
+	GENERATED_BODY()
+
+	/** The number of times the output pin has been executed. */
+	UPROPERTY()
+	uint32 Count = 0;
+};
+
 /**
  * Executes output pin only N times before needing to be reset.
  */
@@ -20,13 +31,27 @@ public:
 	UPROPERTY(EditAnywhere, Category="Do N", meta=(GF_Debuggable="enabled"))
 	uint32 N;
 	
+	/** Do N node input pins. */
+	enum class EInputPin : int32 { Enter, Reset, Num };
+
+	/** Do N node output pins. */
+	enum class EOutputPin : int32 { Exit, Num };
+
+	static const TGameFlowPins<EInputPin> InputPins;
+	static const TGameFlowPins<EOutputPin> OutputPins;
+	
 	UGameFlowNode_FlowControl_DoN();
+
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const override { return InputPins.GetNames(); }
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const override { return OutputPins.GetNames(); }
+	virtual UScriptStruct* GetInstanceStateStruct() const override { return FGameFlowNode_FlowControl_DoN_State::StaticStruct(); }
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
 	
 	virtual void Execute_Implementation(const FName PinName) override;
+	virtual void ExecutePin(int32 PinIndex, FName PinName) override;
     virtual void OnFinishExecute_Implementation() override;
-private:
-	
-	/** The number of times the output pin has been executed. */
-	UPROPERTY(meta=(GF_Debuggable="enabled"))
-	uint32 Count;
+
+#if WITH_EDITOR
+	virtual FString GetCustomDebugInfo() const override;
+#endif
 };
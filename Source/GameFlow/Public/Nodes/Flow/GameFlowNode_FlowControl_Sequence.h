@@ -18,5 +18,7 @@ public:
 
 	UGameFlowNode_FlowControl_Sequence();
 
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
+
 	virtual void Execute_Implementation(const FName PinName) override;
 };
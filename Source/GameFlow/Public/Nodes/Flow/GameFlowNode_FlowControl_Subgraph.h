@@ -4,13 +4,38 @@
 
 #include "CoreMinimal.h"
 #include "GameFlowAsset.h"
+#include "Engine/StreamableManager.h"
+#include "Execution/GameFlowInstanceHandle.h"
 #include "Nodes/GameFlowNode.h"
 #include "UObject/Object.h"
 #include "GameFlowNode_FlowControl_Subgraph.generated.h"
 
+class UGameFlowSubsystem;
+
+/** Per-instance state of a subgraph node. */
+USTRUCT()
+struct FGameFlowNode_FlowControl_Subgraph_State
+{
+	GENERATED_BODY()
+
+	/** Keeps the subgraph asset loaded, once requested. */
+	TSharedPtr<FStreamableHandle> LoadHandle;
+
+	/** The running instance of the subgraph, if any. */
+	FGameFlowInstanceHandle RunningInstance;
+
+	/** Entry points reached while the subgraph asset was still loading. */
+	TArray<FName> PendingEntries;
+
+	/** Snapshot of the subgraph instance read while the subgraph asset was not loaded, restored once it is. */
+	TArray<uint8> PendingSnapshot;
+};
+
 /**
  * Start execution of a game flow asset from another graph.
- * @remark Instanced subgraph will be a child of the current graph.
+ * The subgraph asset is loaded asynchronously, either when the owner instance is created or
+ * when execution gets close to this node, and its instances come from the game flow subsystem pools.
+ * Reaching an exit point of the subgraph triggers the output pin with the same name.
  */
 UCLASS(NotBlueprintType, Blueprintable, DisplayName="Subgraph", meta=(Category="Flow Control"))
 class GAMEFLOW_API UGameFlowNode_FlowControl_Subgraph : public UGameFlowNode
@@ -22,22 +47,43 @@ public:
 	UPROPERTY(EditAnywhere, Category="Game Flow|Subgraph", meta=(GF_Debuggable="enabled"))
 	TSoftObjectPtr<UGameFlowAsset> Asset;
 
-private:
-	/** The instance of the referenced asset. */
-	UPROPERTY(DuplicateTransient, Transient)
-	TObjectPtr<UGameFlowAsset> InstancedAsset;
-
-public:
 	UGameFlowNode_FlowControl_Subgraph();
 	virtual void Execute_Implementation(const FName PinName) override;
 
+	virtual UScriptStruct* GetInstanceStateStruct() const override { return FGameFlowNode_FlowControl_Subgraph_State::StaticStruct(); }
+	virtual void ReleaseInstanceState(void* State) const override;
+	virtual void SerializeInstanceState(FArchive& Ar, void* State) override;
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
+	virtual bool IsLatent() const override { return true; }
+	virtual bool NeedsPreload() const override { return !Asset.IsNull(); }
+	virtual void Preload() override;
+
+private:
+	/** Start loading the subgraph asset for the instance currently executing this node, if not done yet. */
+	void RequestLoad(FGameFlowNode_FlowControl_Subgraph_State& State);
+
+	/** Enter all the entry points reached while the subgraph asset was loading. */
+	void OnSubgraphLoaded();
+
+	/** Execute an entry point of the subgraph, creating its instance if not running. */
+	void EnterSubgraph(FName EntryPointName);
+
+	/** Forward the exit points of a subgraph instance to the output pins of this node. */
+	void BindSubgraphExits(UGameFlowAsset* SubgraphInstance);
+
+	/** Forward a reached subgraph exit point to the matching output pin. */
+	void OnSubgraphExit(FName ExitPointName);
+
+	UGameFlowSubsystem* GetGameFlowSubsystem() const;
+
 #if WITH_EDITOR
+public:
     virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
 
 private:
-	void ReconstructSubgraph();
-    void ConstructInputPins();
-    void ConstructOutputPins();
+	void ReconstructSubgraph(const UGameFlowAsset* SubgraphAsset);
+    void ConstructInputPins(const UGameFlowAsset* SubgraphAsset);
+    void ConstructOutputPins(const UGameFlowAsset* SubgraphAsset);
 	
     bool CanInstanceAssetFromSource(const UGameFlowAsset* LoadedAsset) const;
     virtual void GetNodeIconInfo(FString& Key, FLinearColor& Color) const override;
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "PinHandle.h"
+#include "GameFlowPins.h"
 #include "Pins/InputPinHandle.h"
 #include "Pins/OutPinHandles.h"
 #include "GameFlowNode.generated.h"
@@ -16,6 +17,9 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAssetExecuted, UInputPinHandle*,
 
 #endif
 
+class UGameFlowAsset;
+struct FGameFlowProgramNode;
+
 /**
  * Represents a single node in a Game Flow asset. This class forms the basis for all nodes in the Game Flow system,
  * ensuring a consistent interface for execution and pin management.
@@ -32,29 +36,138 @@ class GAMEFLOW_API UGameFlowNode : public UObject
 	friend class UPinHandle;
 	friend class UExecPinHandle;
 	friend class UOutPinHandle;
+	friend struct FGameFlowProgram;
 	
 	GENERATED_BODY()
 
 public:
 
-	/** Node input pins. */
-	UPROPERTY(EditDefaultsOnly, Instanced, Category="Game Flow|I/O")
-	TMap<FName, UInputPinHandle*> Inputs;
-	
-	/** Node output pins. */
-	UPROPERTY(EditDefaultsOnly, Instanced, Category="Game Flow|I/O", meta=(DisplayAfter="Inputs"))
-	TMap<FName, UOutPinHandle*> Outputs;
-	
 	UGameFlowNode();
 
+	/** Get the index of this node inside the owner asset compiled program. */
+	FORCEINLINE int32 GetProgramIndex() const { return ProgramIndex; }
+
+	/**
+	 * Get the dense ID identifying this node inside its owner asset, available in cooked builds.
+	 * IDs are assigned when the program is compiled, and stay the same as long as the graph is unchanged.
+	 */
+	FORCEINLINE int32 GetNodeId() const { return ProgramIndex; }
+
+	/**
+	 * Get the asset instance this node is running for. Nodes shared between
+	 * instances resolve it from the instance currently executing them.
+	 */
+	UGameFlowAsset* GetOwnerInstance() const;
+
+	virtual UWorld* GetWorld() const override;
+
 	/**
 	 * Attempts to execute the current game flow node associated with the specified input pin.
 	 *
 	 * @param PinName The name of the input pin that triggered this execution attempt.
+	 * @param PinIndex The index of the input pin relative to the node compiled pins, INDEX_NONE if unknown.
 	 */
-	void TryExecute(FName PinName);
-	
+	void TryExecute(FName PinName, int32 PinIndex = INDEX_NONE);
+
+	/**
+	 * Get the input pins declared at compile time by this node class, in declaration order.
+	 * The position of each pin inside the returned array is also its integer pin index.
+	 */
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const { return {}; }
+
+	/**
+	 * Get the output pins declared at compile time by this node class, in declaration order.
+	 * The position of each pin inside the returned array is also its integer pin index.
+	 */
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const { return {}; }
+
+	/**
+	 * Get the struct holding the per-instance mutable state of this node, if any.
+	 * When an asset instance shares its nodes, one struct of this type is allocated
+	 * for each instance, and nodes should keep their runtime state inside it.
+	 */
+	virtual UScriptStruct* GetInstanceStateStruct() const { return nullptr; }
+
+	/**
+	 * Initialize the per-instance state of this node, after it has been constructed.
+	 * @param State The node state struct, of type GetInstanceStateStruct().
+	 * @param ProgramNode The compiled entry of this node.
+	 */
+	virtual void InitializeInstanceState(void* State, const FGameFlowProgramNode& ProgramNode) const {}
+
+	/**
+	 * Release all the resources bound to the per-instance state of this node (e.g. timers),
+	 * before the state gets reset. Called while the owner instance is executing.
+	 * @param State The node state struct, of type GetInstanceStateStruct().
+	 */
+	virtual void ReleaseInstanceState(void* State) const {}
+
+	/**
+	 * Write the per-instance state of this node to an instance snapshot, or read it back.
+	 * Called while the owner instance is executing. Default implementation serializes the
+	 * UPROPERTY members of the state struct, nodes holding handles should override it.
+	 * @param State The node state struct, of type GetInstanceStateStruct().
+	 */
+	virtual void SerializeInstanceState(FArchive& Ar, void* State);
+
+	/**
+	 * Can this node object be shared between multiple instances of the owner asset?
+	 * Only nodes which never mutate their own properties during execution, keeping all
+	 * their runtime state inside GetInstanceStateStruct(), should return true.
+	 */
+	virtual bool CanBeSharedBetweenInstances() const { return false; }
+
+	/**
+	 * Does this node keep running once its execution returns, e.g. waiting for timers or world events?
+	 * Latent nodes keep the assets within their reach loaded until they call FinishExecute(). Blueprint
+	 * nodes may wait on latent actions, and are expected to call FinishExecute() too.
+	 */
+	virtual bool IsLatent() const { return GetClass()->HasAnyClassFlags(CLASS_CompiledFromBlueprint); }
+
+	/**
+	 * Called when a timer set by this node inside the game flow timing wheel expires.
+	 * Called while the owner instance is executing.
+	 * @param Payload The value the timer has been set with.
+	 */
+	virtual void OnTimerExpired(int32 Payload) {}
+
+	/**
+	 * Does this node reference content which should be loaded before execution reaches it?
+	 * Evaluated when the owner asset program is loaded, see UGameFlowRuntimeSettings::SubgraphPreloadHops.
+	 */
+	virtual bool NeedsPreload() const { return false; }
+
+	/**
+	 * Start loading the content this node depends on, without blocking. Called while
+	 * the owner instance is executing, ahead of this node execution. May be called more than once.
+	 */
+	virtual void Preload() {}
+
+	/**
+	 * Gather the soft assets this node needs when executing, so that they can be loaded while
+	 * execution gets close to it, see UGameFlowRuntimeSettings::AssetPrefetchHops.
+	 * Default implementation gathers all the soft object, soft class and soft object path properties
+	 * of the node, including the ones inside containers and structs.
+	 * @param OutPaths Paths of the referenced assets, appended to the array.
+	 */
+	virtual void GetPrefetchAssets(TArray<FSoftObjectPath>& OutPaths) const;
+
+	/** Report the memory used by this node, including its pin objects inside the editor. */
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
 protected:
+	/**
+	 * Get the per-instance state of this node for the instance currently executing it.
+	 * @return The node state, nullptr if the node has no state or is not running.
+	 */
+	void* GetInstanceStateMemory() const;
+
+	template<typename TState>
+	FORCEINLINE TState* GetInstanceState() const
+	{
+		return static_cast<TState*>(GetInstanceStateMemory());
+	}
+	
 	/** Executes the node logic associated with the specified PinName.
 	 *
 	 * @param PinName The name of the pin to execute. Defaults to "Exec".
@@ -63,6 +176,16 @@ protected:
 	FORCEINLINE void Execute(const FName PinName = "Exec");
 	FORCEINLINE virtual void Execute_Implementation(const FName PinName) {}
 
+	/**
+	 * Executes the node logic associated with the specified input pin index.
+	 * Native nodes with declared pins can override this to switch on the pin index
+	 * instead of comparing names. Never called on Blueprint generated classes.
+	 *
+	 * @param PinIndex The index of the triggered input pin.
+	 * @param PinName The name of the triggered input pin.
+	 */
+	virtual void ExecutePin(int32 PinIndex, FName PinName) { Execute(PinName); }
+
 	/**
 	 * Triggers upon completion of the execution in a Game Flow node.
 	 */
@@ -85,6 +208,36 @@ protected:
 	 */
 	UFUNCTION(BlueprintCallable, Category="Game Flow")
 	FORCEINLINE void TriggerOutputPin(FName PinName);
+
+	/**
+	 * Triggers the specified output pin by name during the next frame, instead of the current one.
+	 *
+	 * @param PinName The name of the output pin to be triggered.
+	 */
+	UFUNCTION(BlueprintCallable, Category="Game Flow")
+	void TriggerOutputPinDeferred(FName PinName);
+
+	/**
+	 * Triggers the specified output pin by its index relative to the node compiled pins.
+	 *
+	 * @param PinIndex The index of the output pin to be triggered.
+	 */
+	void TriggerOutputPinByIndex(int32 PinIndex);
+
+	/**
+	 * Triggers an output pin declared at compile time through TGameFlowPins.
+	 *
+	 * @param Pin The declared output pin to be triggered.
+	 */
+	template<typename TPinEnum, typename = typename TEnableIf<TIsEnumClass<TPinEnum>::Value>::Type>
+	FORCEINLINE void TriggerOutputPin(TPinEnum Pin)
+	{
+		TriggerOutputPinByIndex(static_cast<int32>(Pin));
+	}
+	
+	/** Index of this node inside the owner asset compiled program. Assigned when the program is compiled. */
+	UPROPERTY()
+	int32 ProgramIndex;
 	
 	/** Returns a list of all types of nodes defined inside Project Setting at Plugins/GameFlow. */
 	UFUNCTION(BlueprintGetter, CallInEditor)
@@ -95,6 +248,17 @@ protected:
 	
 public:
 
+	/**
+	 * Node input pins. Pin objects only exist inside the editor, the runtime walks
+	 * the pins and connections lowered into the owner asset compiled program.
+	 */
+	UPROPERTY(EditDefaultsOnly, Instanced, Category="Game Flow|I/O")
+	TMap<FName, UInputPinHandle*> Inputs;
+	
+	/** Node output pins. Editor-only, like the input pins. */
+	UPROPERTY(EditDefaultsOnly, Instanced, Category="Game Flow|I/O", meta=(DisplayAfter="Inputs"))
+	TMap<FName, UOutPinHandle*> Outputs;
+
 	/** Used to uniquely identify a node asset inside the editor.
 	 * ID is shared between instances of game flow asset. */
 	UPROPERTY(TextExportTransient)
@@ -189,15 +353,16 @@ public:
 	UPinHandle* GetPinByName(FName PinName, TEnumAsByte<EEdGraphPinDirection> Direction) const;
 
 	/**
-	 * Retrieves an array of pins associated with the specified direction.
-	 * This can include input or output pins depending on the given direction.
+	 * Call a function on each pin of the specified direction, without copying the pins.
+	 * Pins should not be added or removed from the visitor.
 	 *
-	 * @param Direction The direction of the pins to retrieve (e.g., input or output).
-	 * @return An array containing the pins of the specified direction.
+	 * @param Direction The direction of the pins to visit (e.g., input or output).
+	 * @param Visitor Called with the name and the handle of each pin. Handles may be nullptr.
 	 */
-	TArray<UPinHandle*> GetPinsByDirection(TEnumAsByte<EEdGraphPinDirection> Direction) const;
-	TArray<FName> GetInputPinsNames() const;
-	TArray<FName> GetOutputPinsNames() const;
+	void ForEachPin(TEnumAsByte<EEdGraphPinDirection> Direction, TFunctionRef<void(FName, UPinHandle*)> Visitor) const;
+
+	/** Get the number of pins of the specified direction. */
+	int32 GetNumPins(TEnumAsByte<EEdGraphPinDirection> Direction) const;
 
 	/**
 	 * Computes the difference between the pins of this node and another node, given a specific direction.
@@ -17,7 +17,15 @@ class GAMEFLOW_API UGameFlowNode_Input final : public UGameFlowNode
 
 public:
 
+	/** Input node output pins. */
+	enum class EOutputPin : int32 { Out, Num };
+
+	static const TGameFlowPins<EOutputPin> OutputPins;
+	
 	UGameFlowNode_Input();
 
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const override { return OutputPins.GetNames(); }
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
+
 	virtual void Execute_Implementation(const FName PinName) override;
 };
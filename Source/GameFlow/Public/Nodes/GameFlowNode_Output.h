@@ -17,7 +17,15 @@ class GAMEFLOW_API UGameFlowNode_Output final : public UGameFlowNode
 
 public:
 
+	/** Output node input pins. */
+	enum class EInputPin : int32 { Exec, Num };
+
+	static const TGameFlowPins<EInputPin> InputPins;
+	
 	UGameFlowNode_Output();
+
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const override { return InputPins.GetNames(); }
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
 	
 	virtual void Execute_Implementation(const FName PinName) override;
 	
@@ -0,0 +1,60 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Compile-time pin declaration for native game flow nodes.
+ * Pins are identified by an enum class terminated by a 'Num' entry, and
+ * named through a table with one entry per enum value. Declared pins are
+ * laid out first and in declaration order inside the compiled program, so
+ * their enum value is also their dense integer pin index.
+ *
+ * Usage:
+ *	enum class EInputPin : int32 { Start, Stop, Num };
+ *	static const TGameFlowPins<EInputPin> InputPins;
+ *	...
+ *	const TGameFlowPins<UMyNode::EInputPin> UMyNode::InputPins({ TEXT("Start"), TEXT("Stop") });
+ */
+template<typename TPinEnum>
+class TGameFlowPins
+{
+	static_assert(TIsEnumClass<TPinEnum>::Value, "Game flow pins should be declared through an enum class.");
+
+public:
+	/** The number of declared pins. */
+	static constexpr int32 NumPins = static_cast<int32>(TPinEnum::Num);
+
+	template<int32 N>
+	explicit TGameFlowPins(const TCHAR* const (&InNames)[N])
+	{
+		static_assert(N == NumPins, "Game flow pins table should name every value of the pins enum.");
+		for (int32 Index = 0; Index < N; ++Index)
+		{
+			Names[Index] = FName(InNames[Index]);
+		}
+	}
+
+	/** Get the name of a declared pin. */
+	FORCEINLINE FName operator[](TPinEnum Pin) const { return Names[static_cast<int32>(Pin)]; }
+
+	/** Get the names of all declared pins, in declaration order. */
+	FORCEINLINE TConstArrayView<FName> GetNames() const { return MakeArrayView(Names, NumPins); }
+
+	/**
+	 * Find a declared pin index by name.
+	 * @return The pin index, INDEX_NONE if the pin has not been declared.
+	 */
+	FORCEINLINE int32 IndexOf(FName PinName) const
+	{
+		for (int32 Index = 0; Index < NumPins; ++Index)
+		{
+			if (Names[Index] == PinName) return Index;
+		}
+		return INDEX_NONE;
+	}
+
+private:
+	FName Names[NumPins];
+};
@@ -6,28 +6,41 @@
 #include "Nodes/GameFlowNode.h"
 #include "GameFlowNode_LogicalOperator_AND.generated.h"
 
-/**
- * Game Flow AND logical operator.
- */
-UCLASS(NotBlueprintable, NotBlueprintType, DisplayName="AND", meta=(Category="Flow Control"))
-class GAMEFLOW_API UGameFlowNode_LogicalOperator_AND final : public UGameFlowNode
+/** Per-instance state of an AND node. */
+USTRUCT()
+struct FGameFlowNode_LogicalOperator_AND_State
 {
 	GENERATED_BODY()
 
-private:
 	/** All the ports which should evaluate to true for the AND operator to execute it's output. */
 	UPROPERTY()
 	TArray<bool> ConditionalPorts;
 
 	/** The number of ports which are currently evaluated to true. */
-	UPROPERTY(meta=(GF_Debuggable="enabled"))
-	int ActiveInputs;
+	UPROPERTY()
+	int32 ActiveInputs = 0;
+};
+
+/**
+ * Game Flow AND logical operator.
+ */
+UCLASS(NotBlueprintable, NotBlueprintType, DisplayName="AND", meta=(Category="Flow Control"))
+class GAMEFLOW_API UGameFlowNode_LogicalOperator_AND final : public UGameFlowNode
+{
+	GENERATED_BODY()
 
 public:
 	UGameFlowNode_LogicalOperator_AND();
+	virtual UScriptStruct* GetInstanceStateStruct() const override { return FGameFlowNode_LogicalOperator_AND_State::StaticStruct(); }
+	virtual void InitializeInstanceState(void* State, const FGameFlowProgramNode& ProgramNode) const override;
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
 	virtual void Execute_Implementation(const FName PinName) override;
     virtual void OnFinishExecute_Implementation() override;
+
+#if WITH_EDITOR
+	virtual FString GetCustomDebugInfo() const override;
+#endif
 	
 private:
-	void Reset();
+	static void Reset(FGameFlowNode_LogicalOperator_AND_State& State);
 };
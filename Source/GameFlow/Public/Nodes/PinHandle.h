@@ -37,11 +37,11 @@ public:
 	virtual void TriggerPin();
 
 	/**
-	 * Retrieves all pin handles that are currently connected to this pin handle.
+	 * Retrieves all pin handles that are currently connected to this pin handle, without copying them.
 	 *
-	 * @return An array of pointers to the connected pin handles.
+	 * @return A view of the connected pin handles, invalidated when connections change.
 	 */
-	virtual TArray<UPinHandle*> GetConnections();
+	FORCEINLINE TConstArrayView<UPinHandle*> GetConnections() const { return Connections; }
 
 	/**
 	 * Get the node who owns this pin.
@@ -65,6 +65,13 @@ public:
 	 */
 	virtual bool HasConnections(const UPinHandle* OtherPinHandle) const;
 
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+#if WITH_EDITOR
+	/** Pins are lowered into the compiled program of their asset, cooked builds never load them. */
+	virtual bool IsEditorOnly() const override { return true; }
+#endif
+
 #if WITH_EDITORONLY_DATA
 
 public:
@@ -93,6 +100,9 @@ public:
 	UPROPERTY(Transient, TextExportTransient)
 	double PreviousTime;
 	
+	/** Forward the trigger of this pin to the editor debugger (breakpoints, wire highlight). */
+	virtual void NotifyTriggered();
+	
 	/** Create a connection between this handle and another pin handle. */
 	void CreateConnection(UPinHandle* OtherPinHandle);
 
@@ -102,6 +112,9 @@ public:
 	/** Cut all two-way connections between this and other nodes. */
 	void CutAllConnections();
 
+	/** Forget all the connections of this pin, leaving the connected pins untouched. Used on detached pin copies. */
+	FORCEINLINE void ResetConnections() { Connections.Reset(); }
+
 	/**
 	 * Check if this pin handle is valid and ready to be used.
 	 * @return True if this handle is considered valid, false otherwise.
@@ -22,6 +22,7 @@ public:
 	virtual void TriggerPin() override;
 
 #if WITH_EDITOR
+	virtual void NotifyTriggered() override;
     virtual bool CanCreateConnection(const UPinHandle* OtherPinHandle) const override;
 #endif
 };
@@ -3,9 +3,23 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Execution/GameFlowTimingWheel.h"
 #include "Nodes/GameFlowNode.h"
 #include "GameFlowNode_Utils_Timer.generated.h"
 
+/** Per-instance state of a timer node. */
+USTRUCT()
+struct FGameFlowNode_Utils_Timer_State
+{
+	GENERATED_BODY()
+
+	/** Handle for the currently playing timer. */
+	FGameFlowTimerHandle CompletionTimerHandle;
+	
+	/** Handle for step time*/
+	FGameFlowTimerHandle StepTimerHandle;
+};
+
 /**
  * 
  */
@@ -16,8 +30,26 @@ class GAMEFLOW_API UGameFlowNode_Utils_Timer : public UGameFlowNode
 
 public:
 
+	/** Timer node input pins. */
+	enum class EInputPin : int32 { Start, Stop, Skip, Resume, Num };
+
+	/** Timer node output pins. */
+	enum class EOutputPin : int32 { Completed, Stopped, Step, Skipped, Num };
+
+	static const TGameFlowPins<EInputPin> InputPins;
+	static const TGameFlowPins<EOutputPin> OutputPins;
+	
 	UGameFlowNode_Utils_Timer();
 
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const override { return InputPins.GetNames(); }
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const override { return OutputPins.GetNames(); }
+	virtual UScriptStruct* GetInstanceStateStruct() const override { return FGameFlowNode_Utils_Timer_State::StaticStruct(); }
+	virtual void ReleaseInstanceState(void* State) const override;
+	virtual void SerializeInstanceState(FArchive& Ar, void* State) override;
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
+	virtual bool IsLatent() const override { return true; }
+	virtual void OnTimerExpired(int32 Payload) override;
+
 	/** Amount of time needed to complete the timer. */
 	UPROPERTY(EditAnywhere, meta=(GF_Debuggable="enabled"), Category="Default")
 	float Time;
@@ -32,19 +64,17 @@ public:
 
 private:
 	
-	/** Handle for the currently playing timer. */
-	FTimerHandle CompletionTimerHandle;
-	
-	/** Handle for step time*/
-	FTimerHandle StepTimerHandle;
-	
 	virtual void Execute_Implementation(const FName PinName) override;
+	virtual void ExecutePin(int32 PinIndex, FName PinName) override;
 
 	void StartTimer();
 	void SkipTimer();
 	void ResumeTimer();
 	void StopTimer();
 
+	/** Get the timing wheel of the game flow subsystem running this node, nullptr outside of a game instance. */
+	FGameFlowTimingWheel* GetTimingWheel() const;
+
 #if WITH_EDITOR
     virtual FString GetCustomDebugInfo() const override;
 #endif
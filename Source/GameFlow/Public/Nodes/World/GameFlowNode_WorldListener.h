@@ -4,11 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "GameFlowListener.h"
+#include "GameFlowListenerRouter.h"
 #include "GameplayTagContainer.h"
 #include "Nodes/GameFlowNode.h"
 #include "UObject/Object.h"
 #include "GameFlowNode_WorldListener.generated.h"
 
+class UGameFlowSubsystem;
+
 /**
  * Base class for all nodes which needs to listen for world events.
  */
@@ -30,6 +33,18 @@ public:
 	UPROPERTY(EditAnywhere, Category="World Listener", meta=(GF_Debuggable="enabled"))
 	EGameplayContainerMatchType MatchingStrategy;
 
+	/**
+	 * If greater than 0, only listen to component listeners whose owner is within this distance from ListeningCenter.
+	 * Listeners are tested when the node starts listening, registers or gains a tag: listeners moving inside the radius
+	 * afterwards are not picked up, and listeners moving outside of it keep being listened to until the node finishes.
+	 */
+	UPROPERTY(EditAnywhere, Category="World Listener", meta=(GF_Debuggable="enabled", ClampMin=0, Units="Centimeters"))
+	float ListeningRadius;
+
+	/** World location around which component listeners are listened to, when ListeningRadius is greater than 0. */
+	UPROPERTY(EditAnywhere, Category="World Listener", meta=(EditCondition="ListeningRadius > 0"))
+	FVector ListeningCenter;
+
 	/** The maximum number of times an event can be triggered. if 0 it means indefinite. */
 	UPROPERTY(EditAnywhere, Category="World Listener", meta=(GF_Debuggable="enabled"))
 	uint32 Limit;
@@ -38,9 +53,23 @@ public:
 	UPROPERTY(VisibleAnywhere, Category="World Listener", meta=(GF_Debuggable="enabled"))
 	uint32 Count;
 	
+	/** World listener input pins. */
+	enum class EInputPin : int32 { Start, Stop, Num };
+
+	/** World listener output pins. */
+	enum class EOutputPin : int32 { TriggerEvent, Completed, Stopped, Num };
+
+	static const TGameFlowPins<EInputPin> InputPins;
+	static const TGameFlowPins<EOutputPin> OutputPins;
+	
 	UGameFlowNode_WorldListener();
+
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const override { return InputPins.GetNames(); }
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const override { return OutputPins.GetNames(); }
 	
 	virtual void Execute_Implementation(const FName PinName) override;
+	virtual void ExecutePin(int32 PinIndex, FName PinName) override;
+	virtual bool IsLatent() const override { return true; }
 
 	UFUNCTION()
 	void TryTriggeringEvent(FGameplayTagContainer GameplayTags);
@@ -97,6 +126,37 @@ protected:
 private:
 
 	void UpdateComponentListener(UGameFlowListener* ListenerComponent);
+
+	/** Start listening to a component, unless it is already listened to. */
+	void AddListenedComponent(UGameFlowListener* ListenerComponent);
+
+	/**
+	 * Stop listening to a component, if it is listened to.
+	 * @return True if the component was listened to.
+	 */
+	bool RemoveListenedComponent(UGameFlowListener* ListenerComponent);
+
+	/** Is the owner of a component listener inside the listening radius? Always true without a radius. */
+	bool IsInListeningRadius(const UGameFlowListener* ListenerComponent) const;
+
+	/** Does a component listener match the identity tags of this node? Uses the cached tag masks when possible. */
+	bool DoListenerTagsMatch(const UGameFlowListener* ListenerComponent);
+
+	/** Collect the component listeners this node should listen to. */
+	void QueryNodeListeners(const UGameFlowSubsystem* GameFlowSubsystem, TArray<UGameFlowListener*>& OutListeners) const;
+
+	/** Forward a routed listener event to the matching event handler. */
+	void HandleListenerEvent(EGameFlowListenerEvent Event, UGameFlowListener* ListenerComponent, FGameplayTag Tag);
+
+	/** The components this node is currently listening to, unbound when it finishes. */
+	TArray<TWeakObjectPtr<UGameFlowListener>> ListenedComponents;
+
+	/** Subscription to the listener events involving this node tags. */
+	FGameFlowListenerSubscriptionHandle ListenerEventsHandle;
+
+	/** Identity tags masks, with and without parent tags, cached when the node starts listening. */
+	FGameFlowTagMask IdentityMask;
+	FGameFlowTagMask ExactIdentityMask;
 };
 
 
@@ -22,8 +22,29 @@ public:
 
 	UPROPERTY(EditAnywhere, Category="Notify Listeners", meta=(GF_Debuggable="enabled"))
 	EGameplayContainerMatchType MatchingStrategy;
+
+	/** If greater than 0, only notify the listeners whose owner is within this distance from NotificationCenter. */
+	UPROPERTY(EditAnywhere, Category="Notify Listeners", meta=(GF_Debuggable="enabled", ClampMin=0, Units="Centimeters"))
+	float NotificationRadius;
+
+	/** World location around which listeners are notified, when NotificationRadius is greater than 0. */
+	UPROPERTY(EditAnywhere, Category="Notify Listeners", meta=(EditCondition="NotificationRadius > 0"))
+	FVector NotificationCenter;
+	
+	/** Notify listeners node input pins. */
+	enum class EInputPin : int32 { Exec, Num };
+
+	/** Notify listeners node output pins. */
+	enum class EOutputPin : int32 { Out, Num };
+
+	static const TGameFlowPins<EInputPin> InputPins;
+	static const TGameFlowPins<EOutputPin> OutputPins;
 	
 	UGameFlowNode_WorldListener_NotifyListeners();
+
+	virtual TConstArrayView<FName> GetDeclaredInputPins() const override { return InputPins.GetNames(); }
+	virtual TConstArrayView<FName> GetDeclaredOutputPins() const override { return OutputPins.GetNames(); }
+	virtual bool CanBeSharedBetweenInstances() const override { return true; }
     
 	virtual void Execute_Implementation(const FName PinName) override;
 	virtual void OnFinishExecute_Implementation() override;
@@ -325,11 +325,10 @@ void GameFlowAssetToolkit::OnPostPIEStarted(bool bStarted)
 		PIE_SelectedWorld = WorldContext->World();
 		
 		const UGameFlowSubsystem* Subsystem = PIE_SelectedWorld->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
-		const TArray<UGameFlowAsset*> InstancedAssets = Subsystem->GetRunningFlows();
 		// If there is at least one instance of the inspected game flow asset, select the first you can find by default.
-		if(InstancedAssets.Num() > 0)
+		UGameFlowAsset* InstancedAsset = Subsystem->GetRunningFlowByArchetype(Asset);
+		if(InstancedAsset != nullptr)
 		{
-			UGameFlowAsset* InstancedAsset = Subsystem->GetRunningFlowByArchetype(Asset->GetArchetype());
 			SelectPIEAssetInstance(InstancedAsset);
 		}
 		
@@ -462,7 +461,7 @@ TSharedRef<SWidget> GameFlowAssetToolkit::BuildSelectAssetInstanceMenu()
 	if(PIE_SelectedWorld != nullptr)
 	{
 		const UGameFlowSubsystem* Subsystem = PIE_SelectedWorld->GetGameInstance()->GetSubsystem<UGameFlowSubsystem>();
-		for(UGameFlowAsset* Instance : Subsystem->GetRunningFlows())
+		for(UGameFlowAsset* Instance : Subsystem->GetRunningInstances())
 		{
 			OptionsMenuBuilder.AddMenuEntry(FText::FromString(Instance->GetName()), FText::GetEmpty(),
 			FSlateIcon(), FExecuteAction::CreateLambda([this, Instance]
@@ -1,6 +1,7 @@
 ﻿// Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Asset/Graph/GameFlowGraph.h"
+#include "GameFlowMemory.h"
 #include "GraphEditAction.h"
 #include "Asset/Graph/GameFlowGraphSchema.h"
 #include "Asset/Graph/Actions/FGameFlowSchemaAction_ReplaceNode.h"
@@ -18,6 +19,7 @@ UGameFlowGraph::UGameFlowGraph()
 
 void UGameFlowGraph::InitGraph()
 {
+	LLM_SCOPE_BYTAG(GameFlow_EditorGraphs);
 	const UGameFlowGraphSchema* GraphSchema = CastChecked<UGameFlowGraphSchema>(GetSchema());
 	
 	// Listen to editor events.
@@ -147,6 +149,7 @@ void UGameFlowGraph::OnDebugModeUpdated(bool bEnabled)
 
 void UGameFlowGraph::NotifyGraphChanged(const FEdGraphEditAction& Action)
 {
+	LLM_SCOPE_BYTAG(GameFlow_EditorGraphs);
 	// We want to use a set of UGameFlowGraphNode type.
 	TSet<const UGameFlowGraphNode*> ModifiedNodes;
 	for (const UEdGraphNode* Node : Action.Nodes)
@@ -259,12 +262,13 @@ void UGameFlowGraph::OnNodesAdded(const TSet<const UGameFlowGraphNode*> AddedNod
 
 void UGameFlowGraph::RebuildGraphFromAsset()
 {
+	LLM_SCOPE_BYTAG(GameFlow_EditorGraphs);
 	const UGameFlowGraphSchema* GameFlowSchema = CastChecked<UGameFlowGraphSchema>(GetSchema());
 	
 	// Recreate all game flow asset registered nodes, including orphan nodes.
 	// Orphans are nodes that do not share connections with any parent node,
 	// e.g. their input pins have no links.
-	for(UGameFlowNode* NodeAsset : GameFlowAsset->GetNodes())
+	for(const auto& [GUID, NodeAsset] : GameFlowAsset->GetNodes())
 	{
 		UGameFlowGraphNode* GraphNode = FGameFlowNodeSchemaAction_CreateOrDestroyNode::RecreateNode(NodeAsset, this);
 		GraphNode->NodePosX = NodeAsset->GraphPosition.X;
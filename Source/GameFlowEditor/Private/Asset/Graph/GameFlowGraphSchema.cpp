@@ -151,8 +151,8 @@ UEdGraphNode* UGameFlowGraphSchema::CreateSubstituteNode(UEdGraphNode* Node, con
 	// image of the old node.
 	for(UEdGraphPin* Pin : Node->Pins)
 	{
-		const int32 SubstituteInputPinsNum = SubstituteNodeAsset->GetInputPinsNames().Num();
-		const int32 SubstituteOutputPinsNum = SubstituteNodeAsset->GetOutputPinsNames().Num();
+		const int32 SubstituteInputPinsNum = SubstituteNodeAsset->GetNumPins(EGPD_Input);
+		const int32 SubstituteOutputPinsNum = SubstituteNodeAsset->GetNumPins(EGPD_Output);
 		
 		UEdGraphPin* SubstituteNodePin = SubstituteNode->FindPin(Pin->PinName);
 		// Have we found a pin with the same name in the substitute node?
@@ -319,7 +319,7 @@ void UGameFlowGraphSchema::RecreateBranchConnections(const UGameFlowGraph& Graph
 		const UGameFlowNode* CurrentNodeAsset = CurrentNode->GetNodeAsset();
 		CurrentNode->bIsRebuilding = true;
 		
-		for(UPinHandle* OutputPinHandle : CurrentNodeAsset->GetPinsByDirection(EGPD_Output))
+		for(const auto& [OutputPinName, OutputPinHandle] : CurrentNodeAsset->Outputs)
 		{
 			const bool bIsValidHandle = IsValid(OutputPinHandle) && OutputPinHandle->IsValidHandle();
 			// If the output pin is not valid, skip to the next iteration; it cannot be processed.
@@ -21,6 +21,7 @@
 #include "Config/FGameFlowNodeInfo.h"
 #include "Config/GameFlowEditorSettings.h"
 #include "Engine/StreamableManager.h"
+#include "Execution/GameFlowInstanceState.h"
 #include "Framework/Commands/GenericCommands.h"
 #include "Widget/SGameFlowReplaceNodeDialog.h"
 #include "Widget/Nodes/SGameFlowNode.h"
@@ -151,7 +152,10 @@ FText UGameFlowGraphNode::GetDebugInfoText() const
 		}
 	}
 	
-	// String used to display more advanced debug messages.
+	// String used to display more advanced debug messages. Nodes shared between instances
+	// read their state from the debugged instance, publish it while they are queried.
+	UGameFlowAsset* DebuggedAssetInstance = CastChecked<UGameFlowGraph>(GetGraph())->DebuggedAssetInstance;
+	FGameFlowInstanceScope InstanceScope(DebuggedAssetInstance);
 	FString CustomDebugString = InspectedNode->GetCustomDebugInfo();
 	DebugInfoStatus.Append(CustomDebugString);
 	
@@ -456,16 +460,16 @@ void UGameFlowGraphNode::MarkNodeAsPendingCompilation()
 void UGameFlowGraphNode::AllocateDefaultPins()
 {
 	// Read input pins names from the node asset and create graph pins.
-	for (const FName& PinName : NodeAsset->GetInputPinsNames())
+	NodeAsset->ForEachPin(EGPD_Input, [this](FName PinName, UPinHandle* PinHandle)
 	{
 		CreateNodePin(EGPD_Input, PinName, false);
-	}
+	});
 
 	// Read output pins names from the node asset and create graph pins.
-	for (const FName& PinName : NodeAsset->GetOutputPinsNames())
+	NodeAsset->ForEachPin(EGPD_Output, [this](FName PinName, UPinHandle* PinHandle)
 	{
 		CreateNodePin(EGPD_Output, PinName, false);
-	}
+	});
 }
 
 void UGameFlowGraphNode::GetNodeContextMenuActions(UToolMenu* Menu, UGraphNodeContextMenuContext* Context) const
@@ -770,19 +774,13 @@ void UGameFlowGraphNode::Initialize()
 	NodeAsset->OnErrorEvent.AddUObject(this, &UGameFlowGraphNode::ReportError);
 	NodeAsset->OnAssetExecuted.AddDynamic(this, &UGameFlowGraphNode::OnNodeAssetExecuted);
 
-	TArray<UPinHandle*> InputPins = NodeAsset->GetPinsByDirection(EEdGraphPinDirection::EGPD_Input);
-	// Listen for all the node input pins trigger event.
-	for (UPinHandle* PinHandle : InputPins)
+	// Listen for all the node input and output pins trigger event.
+	auto ListenToPin = [this](FName PinName, UPinHandle* PinHandle)
 	{
 		PinHandle->OnPinTriggered.AddDynamic(this, &UGameFlowGraphNode::TriggerBreakpoint);
-	}
-
-	TArray<UPinHandle*> OutputPins = NodeAsset->GetPinsByDirection(EEdGraphPinDirection::EGPD_Output);
-	// Listen for all the node output pins trigger event.
-	for (UPinHandle* PinHandle : OutputPins)
-	{
-		PinHandle->OnPinTriggered.AddDynamic(this, &UGameFlowGraphNode::TriggerBreakpoint);
-	}
+	};
+	NodeAsset->ForEachPin(EGPD_Input, ListenToPin);
+	NodeAsset->ForEachPin(EGPD_Output, ListenToPin);
 }
 
 void UGameFlowGraphNode::ReconstructNode()
@@ -933,7 +931,6 @@ UEdGraphPin* UGameFlowGraphNode::CreateNodePin(const EEdGraphPinDirection PinDir
 			// Add input pin to node asset.
 			case EGPD_Input:
 				{
-					TArray<FName> InputPins = NodeAsset->GetInputPinsNames();
 					PinName = CreateUniquePinName(PinName);
 					NodeAsset->AddPin(PinName, EGPD_Input, UInputPinHandle::StaticClass());
 					break;
@@ -942,7 +939,6 @@ UEdGraphPin* UGameFlowGraphNode::CreateNodePin(const EEdGraphPinDirection PinDir
 			// Add output pin to node asset.	
 			case EGPD_Output:
 				{
-					TArray<FName> OutputPins = NodeAsset->GetOutputPinsNames();
 					PinName = CreateUniquePinName(PinName);
 					NodeAsset->AddPin(PinName, EGPD_Output, UOutPinHandle::StaticClass());
 					break;